@@ -1,6 +1,14 @@
 QT       += core gui sql widgets network concurrent
 CONFIG += c++17
 
+# 在线备份默认使用 VACUUM INTO 与 ATTACH 逐表复制（sqlite_backup.cpp），只经过 QSQLITE 驱动。
+# Qt 以 -system-sqlite 构建时可用 qmake CONFIG+=system_sqlite 改用 SQLite backup API 逐页复制；
+# Qt 自带的 SQLite（如官方 MinGW 套件）不能开启，否则驱动与 libsqlite3 是两份不同的 SQLite
+CONFIG(system_sqlite) {
+    DEFINES += ACCOUNTBOOK_SYSTEM_SQLITE
+    LIBS += -lsqlite3
+}
+
 
 SOURCES += \
     account_add_widget.cpp \
@@ -14,20 +22,29 @@ SOURCES += \
     bill_service.cpp \
     budget_manager.cpp \
     budget_dialog.cpp \
+    category_registry.cpp \
     bill_sync_client.cpp \
+    db_benchmark.cpp \
+    db_maintenance.cpp \
     db_manager.cpp \
+    db_self_test.cpp \
     email_config_dialog.cpp \
     email_sender.cpp \
     main.cpp \
     mainwindow.cpp \
+    month_cache.cpp \
+    range_sum_index.cpp \
+    record_columns.cpp \
     server_main.cpp \
     sqlite_helper.cpp \
+    sqlite_backup.cpp \
     statistics_manager.cpp \
     statistics_widget.cpp \
     sync_manager.cpp \
     tcp_server.cpp \
     tcpclient.cpp \
     thread_manager.cpp \
+    timestamp_parser.cpp \
     User.cpp \
     user_handler.cpp \
     user_info_widget.cpp \
@@ -55,20 +72,29 @@ HEADERS += \
     bill_service.h \
     budget_manager.h \
     budget_dialog.h \
+    category_registry.h \
     bill_sync_client.h \
+    db_benchmark.h \
+    db_maintenance.h \
     db_manager.h \
     db_models.h \
+    db_self_test.h \
     email_config_dialog.h \
     email_sender.h \
     mainwindow.h \
+    month_cache.h \
+    range_sum_index.h \
+    record_columns.h \
     server_main.h \
     sqlite_helper.h \
+    sqlite_backup.h \
     statistics_manager.h \
     statistics_widget.h \
     sync_manager.h \
     tcp_server.h \
     tcpclient.h \
     thread_manager.h \
+    timestamp_parser.h \
     User.h \
     user_handler.h \
     user_info_widget.h \
@@ -1,10 +1,17 @@
 #include "account_manager.h"
+#include "month_cache.h"
+#include "range_sum_index.h"
+#include "budget_manager.h"
+#include "timestamp_parser.h"
 #include <QDebug>
+#include <QSqlRecord>
 #include <QDateTime>
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QTcpSocket>
 #include <QApplication>
+#include <QSet>
+#include <algorithm>
 #include "tcpclient.h"
 #include "user_manager.h"
 
@@ -14,56 +21,107 @@ AccountManager::AccountManager() {
 }
 
 int AccountManager::addAccountRecord(const AccountRecord& record) {
+    // 与批量记账走同一路径，ID 由 RETURNING 直接返回，不受其他线程插入的影响
+    QList<int> ids = addAccountRecords({record});
+    if (ids.isEmpty()) {
+        qDebug() << "账单保存失败：" << m_dbHelper->getLastError();
+        return -1;
+    }
+
+    qDebug() << "账单保存成功：用户ID=" << record.getUserId() 
+             << "金额=" << record.getAmount() 
+             << "分类=" << record.getType()
+             << "时间=" << record.getCreateTime();
+
+    // 同步到服务端 (已迁移到 BillService 处理)
+    // syncRecordToServer(record);
+
+    return ids.first();
+}
+
+QList<int> AccountManager::addAccountRecords(const QList<AccountRecord>& records) {
+    QList<int> ids;
+    if (records.isEmpty()) {
+        return ids;
+    }
+
     QString now = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
 
-    // 计算类型：金额小于0为支出(0)，大于等于0为收入(1)
-    int type = (record.getAmount() < 0) ? 0 : 1;
+    // 使用更新后的通用表结构，按列收集数据
+    static const QStringList columns = {
+        "user_id", "bill_date", "amount", "type", "category", "remark",
+        "voucher_path", "is_deleted", "create_time", "modify_time"
+    };
+    QList<QVariantList> values;
+    for (int i = 0; i < columns.size(); ++i) {
+        values.append(QVariantList());
+        values.last().reserve(records.size());
+    }
+    for (const AccountRecord& record : records) {
+        QString recordTime = record.getCreateTime().isEmpty() ? now : record.getCreateTime();
+        values[0] << record.getUserId();
+        values[1] << recordTime;
+        values[2] << record.getAmount();
+        // 计算类型：金额小于0为支出(0)，大于等于0为收入(1)
+        values[3] << ((record.getAmount() < 0) ? 0 : 1);
+        values[4] << record.getType();    // 分类名称
+        values[5] << record.getRemark();  // 备注
+        values[6] << record.getVoucherPath();
+        values[7] << 0;
+        values[8] << recordTime;
+        values[9] << now;
+    }
 
-    // 使用更新后的通用表结构
-    QString sql = QString(R"(
-        INSERT INTO account_record (
-            user_id, bill_date, amount, type, category, remark, 
-            voucher_path, is_deleted, create_time, modify_time
-        ) VALUES (?, ?, ?, ?, ?, ?, ?, 0, ?, ?)
-    )");
-    
-    QString recordTime = record.getCreateTime().isEmpty() ? now : record.getCreateTime();
-    
-    QVariantList params;
-    params << record.getUserId()
-           << recordTime
-           << record.getAmount()
-           << type
-           << record.getType()    // 分类名称
-           << record.getRemark()  // 备注
-           << record.getVoucherPath()
-           << recordTime
-           << now;
-    
-    bool success = m_dbHelper->executeSqlWithParams(sql, params);
-    
-    if (success) {
-        qDebug() << "账单保存成功：用户ID=" << record.getUserId() 
-                 << "金额=" << record.getAmount() 
-                 << "分类=" << record.getType()
-                 << "时间=" << record.getCreateTime();
-
-        // 同步到服务端 (已迁移到 BillService 处理)
-        // syncRecordToServer(record);
-
-        // 获取最后插入的ID
-        QSqlQuery query = m_dbHelper->executeQuery("SELECT last_insert_rowid()");
-        if (query.next()) {
-            return query.value(0).toInt();
-        }
-    } else {
-        qDebug() << "账单保存失败：" << m_dbHelper->getLastError();
+    // 整批一个事务（调用方已开启事务时并入该事务），只提交一次。
+    // 大批量导入时暂停插入触发器，execBatch 写入后按区间补齐汇总与全文索引
+    static const int importThreshold = 1000;
+    qint64 generation = m_dbHelper->recordGeneration();
+    SqliteHelper::BulkWriteResult result = records.size() >= importThreshold
+        ? m_dbHelper->importAccountRecords(columns, values)
+        : m_dbHelper->bulkInsertReturning("account_record", columns, values, 0);
+    if (!result.success) {
+        return ids;
     }
-    
-    return -1;
+
+    ids.reserve(result.rowIds.size());
+    for (qint64 rowId : result.rowIds) {
+        ids.append(static_cast<int>(rowId));
+    }
+    // 期间有其他线程写入时不做写穿透，缓存在下次读取时按计数发现过期
+    qint64 generationAfter = m_dbHelper->ownRecordGeneration(generation);
+    if (generationAfter < 0) {
+        return ids;
+    }
+
+    // 插入的各列都已知，直接写入月度缓存
+    QList<AccountRecord> inserted;
+    inserted.reserve(ids.size());
+    for (int i = 0; i < ids.size() && i < records.size(); ++i) {
+        AccountRecord record = records.at(i);
+        record.setId(ids.at(i));
+        record.setIsDeleted(0);
+        record.setDeleteTime(QString());
+        record.setCreateTime(values[8].at(i).toString());
+        record.setModifyTime(now);
+        inserted.append(record);
+    }
+    MonthCache::getInstance()->upsertRecords(inserted, generation, generationAfter);
+    refreshDerived({}, inserted, generation, generationAfter);
+    return ids;
 }
 
 bool AccountManager::editAccountRecord(const AccountRecord& record) {
+    qint64 generation = m_dbHelper->recordGeneration();
+    QList<AccountRecord> before = recordsBefore({record.getId()});
+    bool success = updateRecordLocal(record);
+    if (success) {
+        writeThroughRecords({record.getId()}, generation, m_dbHelper->ownRecordGeneration(generation), before);
+        syncEditRecordToServer(record);
+    }
+    return success;
+}
+
+bool AccountManager::updateRecordLocal(const AccountRecord& record) {
     QString now = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
     
     // 计算类型：金额小于0为支出(0)，大于等于0为收入(1)
@@ -88,30 +146,40 @@ bool AccountManager::editAccountRecord(const AccountRecord& record) {
            << record.getId()
            << record.getUserId();
 
-    bool success = m_dbHelper->executeSqlWithParams(sql, params);
-    if (success) {
-        syncEditRecordToServer(record);
-    }
-    return success;
+    return m_dbHelper->executeSqlWithParams(sql, params);
 }
 
 bool AccountManager::batchEditAccountRecord(const QList<AccountRecord>& records) {
+    if (records.isEmpty()) return true;
+
+    QList<int> ids;
+    for (const AccountRecord& record : records) {
+        ids.append(record.getId());
+    }
+
     // 开启事务
-    QSqlDatabase db = m_dbHelper->getDatabase();
-    db.transaction();
+    qint64 generation = m_dbHelper->recordGeneration();
+    QList<AccountRecord> before = recordsBefore(ids);
+    if (!m_dbHelper->beginTransaction()) return false;
 
     bool ret = true;
     for (const AccountRecord& record : records) {
-        if (!editAccountRecord(record)) {
+        if (!updateRecordLocal(record)) {
             ret = false;
             break;
         }
     }
 
-    if (ret) db.commit();
-    else db.rollback();
+    if (ret) ret = m_dbHelper->commitTransaction();
+    if (!ret) {
+        m_dbHelper->rollbackTransaction();
+        return false;
+    }
 
-    return ret;
+    // 提交成功后再更新缓存并整批同步，一次往返；回滚的修改不会发给服务端
+    writeThroughRecords(ids, generation, m_dbHelper->ownRecordGeneration(generation), before);
+    syncBatchEditRecordsToServer(records);
+    return true;
 }
 
 bool AccountManager::deleteAccountRecord(int recordId) {
@@ -121,8 +189,15 @@ bool AccountManager::deleteAccountRecord(int recordId) {
         WHERE id = %2
     )").arg(deleteTime).arg(recordId);
 
+    qint64 generation = m_dbHelper->recordGeneration();
+    QList<AccountRecord> before = recordsBefore({recordId});
     bool success = m_dbHelper->executeSql(sql);
     if (success) {
+        qint64 generationAfter = m_dbHelper->ownRecordGeneration(generation);
+        if (generationAfter >= 0) {
+            MonthCache::getInstance()->removeRecords({recordId}, generation, generationAfter);
+            refreshDerived(before, {}, generation, generationAfter);
+        }
         syncDeleteRecordToServer(recordId);
     }
     return success;
@@ -134,8 +209,11 @@ bool AccountManager::restoreAccountRecord(int recordId) {
         WHERE id = %1
     )").arg(recordId);
 
+    qint64 generation = m_dbHelper->recordGeneration();
+    QList<AccountRecord> before = recordsBefore({recordId});
     bool success = m_dbHelper->executeSql(sql);
     if (success) {
+        writeThroughRecords({recordId}, generation, m_dbHelper->ownRecordGeneration(generation), before);
         syncRestoreRecordToServer(recordId);
     }
     return success;
@@ -143,8 +221,15 @@ bool AccountManager::restoreAccountRecord(int recordId) {
 
 bool AccountManager::permanentDeleteAccountRecord(int recordId) {
     QString sql = QString("DELETE FROM account_record WHERE id = %1").arg(recordId);
+    qint64 generation = m_dbHelper->recordGeneration();
+    QList<AccountRecord> before = recordsBefore({recordId});
     bool success = m_dbHelper->executeSql(sql);
     if (success) {
+        qint64 generationAfter = m_dbHelper->ownRecordGeneration(generation);
+        if (generationAfter >= 0) {
+            MonthCache::getInstance()->removeRecords({recordId}, generation, generationAfter);
+            refreshDerived(before, {}, generation, generationAfter);
+        }
         syncPermanentDeleteRecordToServer(recordId);
     }
     return success;
@@ -173,38 +258,350 @@ QList<AccountRecord> AccountManager::queryAccountRecord(int userId,
         condition += QString(" AND amount >= %1 AND amount <= %2").arg(minAmount).arg(maxAmount);
     }
 
-    QString sql = QString("SELECT * FROM account_record WHERE %1 ORDER BY create_time DESC").arg(condition);
+    QString sql = QString("SELECT %1 FROM account_record WHERE %2 ORDER BY create_time DESC")
+                      .arg(RecordRow::selectColumns(), condition);
     QSqlQuery query = m_dbHelper->executeQuery(sql);
 
     // 封装查询结果
+    RecordRow row(query);
+    while (query.next()) {
+        records.append(row.toRecord());
+    }
+
+    return records;
+}
+
+// ============ 行解码 ============
+RecordRow::RecordRow(const QSqlQuery& query) : m_query(query) {
+    // 每个结果集只按列名解析一次位置
+    static const char* const names[ColumnCount] = {
+        "id", "user_id", "amount", "category", "remark", "voucher_path",
+        "is_deleted", "delete_time", "create_time", "modify_time", "bill_ts"
+    };
+    QSqlRecord fields = query.record();
+    for (int i = 0; i < ColumnCount; ++i) {
+        m_pos[i] = fields.indexOf(QString::fromLatin1(names[i]));
+    }
+}
+
+QString RecordRow::selectColumns() {
+    return "id, user_id, amount, category, remark, voucher_path, is_deleted, "
+           "delete_time, create_time, modify_time, bill_ts";
+}
+
+QString RecordRow::summaryColumns() {
+    return "amount, category, create_time, bill_ts";
+}
+
+int RecordRow::id() const { return m_query.value(m_pos[Id]).toInt(); }
+int RecordRow::userId() const { return m_query.value(m_pos[UserId]).toInt(); }
+double RecordRow::amount() const { return m_query.value(m_pos[Amount]).toDouble(); }
+QString RecordRow::category() const { return m_query.value(m_pos[Category]).toString(); }
+QString RecordRow::remark() const { return m_query.value(m_pos[Remark]).toString(); }
+QString RecordRow::voucherPath() const { return m_query.value(m_pos[VoucherPath]).toString(); }
+int RecordRow::isDeleted() const { return m_query.value(m_pos[IsDeleted]).toInt(); }
+QString RecordRow::deleteTime() const { return m_query.value(m_pos[DeleteTime]).toString(); }
+QString RecordRow::createTime() const { return m_query.value(m_pos[CreateTime]).toString(); }
+QString RecordRow::modifyTime() const { return m_query.value(m_pos[ModifyTime]).toString(); }
+
+qint64 RecordRow::billTimestamp(bool* ok) const {
+    if (m_pos[BillTs] >= 0) {
+        QVariant value = m_query.value(m_pos[BillTs]);
+        if (!value.isNull()) {
+            *ok = true;
+            return value.toLongLong();
+        }
+    }
+    return TimestampParser::parse(createTime(), ok);
+}
+
+AccountRecord RecordRow::toRecord() const {
+    AccountRecord record;
+    record.setId(id());
+    record.setUserId(userId());
+    record.setAmount(amount());
+    record.setType(category());
+    record.setRemark(remark());
+    record.setVoucherPath(voucherPath());
+    record.setIsDeleted(isDeleted());
+    record.setDeleteTime(deleteTime());
+    record.setCreateTime(createTime());
+    record.setModifyTime(modifyTime());
+    bool timestampOk = false;
+    qint64 secs = billTimestamp(&timestampOk);
+    if (timestampOk) record.setBillTimestamp(secs);
+    return record;
+}
+
+// ============ 流式遍历 ============
+int AccountManager::forEachRecord(int userId, const RecordFilter& filter, const RecordVisitor& visitor,
+                                  const QString& columns) {
+    QVariantList params;
+    QString condition = buildFilterCondition(userId, filter, params);
+    QString sql = QString("SELECT %1 FROM account_record WHERE %2 ORDER BY create_time DESC, id DESC")
+                      .arg(columns, condition);
+
+    // 语句缓存中的查询是只进的，逐行步进，内存中始终只有当前行
+    SqliteHelper::CachedQuery query = m_dbHelper->executeQueryWithParams(sql, params);
+    if (!query.isActive()) {
+        return -1;
+    }
+
+    int count = 0;
+    RecordRow row(query);
+    while (query.next()) {
+        ++count;
+        if (!visitor(row)) break;
+    }
+    query.finish();
+    return count;
+}
+
+// ============ 键集分页查询 ============
+RecordPage AccountManager::queryAccountRecordPage(int userId,
+                                                  const RecordFilter& filter,
+                                                  const RecordCursor& after,
+                                                  int pageSize) {
+    RecordPage page;
+    pageSize = qBound(1, pageSize, 500);
+
+    QVariantList params;
+    QString condition = buildFilterCondition(userId, filter, params);
+    // 从上一页最后一条之后继续取，沿 (user_id, is_deleted, create_time) 索引定位，不随页数变慢
+    if (after.isValid()) {
+        condition += " AND (create_time, id) < (?, ?)";
+        params << after.createTime << after.id;
+    }
+    // 多取一条用于判断是否还有下一页
+    params << pageSize + 1;
+
+    QString sql = QString("SELECT %1 FROM account_record WHERE %2 "
+                          "ORDER BY create_time DESC, id DESC LIMIT ?").arg(RecordRow::selectColumns(), condition);
+    SqliteHelper::CachedQuery query = m_dbHelper->executeQueryWithParams(sql, params);
+    RecordRow row(query);
     while (query.next()) {
-        AccountRecord record;
-        record.setId(query.value("id").toInt());
-        record.setUserId(query.value("user_id").toInt());
-        record.setAmount(query.value("amount").toDouble());
-        // 兼容旧数据：优先取 category，如果为空取 type (旧版存的是分类名)
-        QString category = query.value("category").toString();
-        if (category.isEmpty()) {
-            category = query.value("type").toString();
+        if (page.records.size() == pageSize) {
+            page.hasMore = true;
+            break;
         }
-        record.setType(category); 
-        
-        record.setRemark(query.value("remark").toString());
-        if (record.getRemark().isEmpty()) {
-            record.setRemark(query.value("description").toString());
+        page.records.append(row.toRecord());
+    }
+    query.finish();
+
+    if (!page.records.isEmpty()) {
+        page.nextCursor.createTime = page.records.last().getCreateTime();
+        page.nextCursor.id = page.records.last().getId();
+    }
+    return page;
+}
+
+SearchPage AccountManager::searchAccountRecords(int userId, const QString& keyword,
+                                                int offset, int pageSize) {
+    SearchPage page;
+    pageSize = qBound(1, pageSize, 500);
+    offset = qMax(0, offset);
+    QString trimmed = keyword.trimmed();
+    if (trimmed.isEmpty()) {
+        return page;
+    }
+
+    QString sql;
+    QVariantList params;
+    if (useFullTextSearch(trimmed)) {
+        // 一次索引查询完成匹配与排序：bm25 越小越相关，分类、备注、描述的权重依次递减
+        QStringList columns;
+        for (const QString& column : RecordRow::selectColumns().split(", ")) {
+            columns << "r." + column;
         }
-        
-        record.setVoucherPath(query.value("voucher_path").toString());
-        record.setIsDeleted(query.value("is_deleted").toInt());
-        record.setDeleteTime(query.value("delete_time").toString());
-        record.setCreateTime(query.value("create_time").toString());
-        record.setModifyTime(query.value("modify_time").toString());
-        records.append(record);
+        sql = QString("SELECT %1 FROM account_record_fts f JOIN account_record r ON r.id = f.rowid "
+                      "WHERE account_record_fts MATCH ? AND r.user_id = ? AND r.is_deleted = 0 "
+                      "ORDER BY bm25(account_record_fts, 2.0, 1.0, 0.5), r.id DESC "
+                      "LIMIT ? OFFSET ?").arg(columns.join(", "));
+        params << fullTextPhrase(trimmed) << userId;
+    } else {
+        RecordFilter filter;
+        filter.keyword = trimmed;
+        QString condition = buildFilterCondition(userId, filter, params);
+        sql = QString("SELECT %1 FROM account_record WHERE %2 "
+                      "ORDER BY create_time DESC, id DESC LIMIT ? OFFSET ?").arg(RecordRow::selectColumns(), condition);
     }
+    // 多取一条用于判断是否还有下一页
+    params << pageSize + 1 << offset;
 
+    SqliteHelper::CachedQuery query = m_dbHelper->executeQueryWithParams(sql, params);
+    RecordRow row(query);
+    while (query.next()) {
+        if (page.records.size() == pageSize) {
+            page.hasMore = true;
+            break;
+        }
+        page.records.append(row.toRecord());
+    }
+    query.finish();
+    page.nextOffset = offset + page.records.size();
+    return page;
+}
+
+bool AccountManager::getAmountSummary(int userId, const RecordFilter& filter,
+                                      double& totalIncome, double& totalExpense) {
+    totalIncome = 0.0;
+    totalExpense = 0.0;
+
+    // 未删除记录按整天筛选且不带关键字时，直接用按天的区间合计
+    QDate firstDay;
+    QDate lastDay;
+    if (!filter.isDeleted && filter.keyword.isEmpty() && wholeDayRange(filter, firstDay, lastDay)) {
+        return getPeriodSummary(userId, firstDay, lastDay, totalIncome, totalExpense);
+    }
+
+    QVariantList params;
+    QString condition = buildFilterCondition(userId, filter, params);
+    QString sql = QString("SELECT COALESCE(SUM(CASE WHEN amount >= 0 THEN amount END), 0), "
+                          "COALESCE(SUM(CASE WHEN amount < 0 THEN -amount END), 0) "
+                          "FROM account_record WHERE %1").arg(condition);
+    SqliteHelper::CachedQuery query = m_dbHelper->executeQueryWithParams(sql, params);
+    if (!query.next()) {
+        return false;
+    }
+    totalIncome = query.value(0).toDouble();
+    totalExpense = query.value(1).toDouble();
+    query.finish();
+    return true;
+}
+
+QString AccountManager::buildFilterCondition(int userId, const RecordFilter& filter, QVariantList& params) {
+    QString condition = "user_id = ? AND is_deleted = ?";
+    params << userId << (filter.isDeleted ? 1 : 0);
+    if (!filter.startTime.isEmpty()) {
+        condition += " AND create_time >= ?";
+        params << filter.startTime;
+    }
+    if (!filter.endTime.isEmpty()) {
+        condition += " AND create_time <= ?";
+        params << filter.endTime;
+    }
+    if (useFullTextSearch(filter.keyword)) {
+        // 先由全文索引取出匹配的 id，其余条件与排序仍沿记录索引完成
+        condition += " AND id IN (SELECT rowid FROM account_record_fts WHERE account_record_fts MATCH ?)";
+        params << fullTextPhrase(filter.keyword);
+    } else if (!filter.keyword.isEmpty()) {
+        condition += " AND (category LIKE ? ESCAPE '\\' OR remark LIKE ? ESCAPE '\\')";
+        QString escaped = filter.keyword;
+        escaped.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+        QString pattern = "%" + escaped + "%";
+        params << pattern << pattern;
+    }
+    return condition;
+}
+
+bool AccountManager::wholeDayRange(const RecordFilter& filter, QDate& firstDay, QDate& lastDay) {
+    // 不限的一端取足够远的日期，区间合计索引会截到已有的范围
+    firstDay = QDate(1900, 1, 1);
+    lastDay = QDate(9999, 12, 31);
+    if (!filter.startTime.isEmpty()) {
+        QStringView start(filter.startTime);
+        if (start.size() != 10 && !start.endsWith(u" 00:00:00")) return false;
+        bool ok = false;
+        qint64 secs = TimestampParser::parse(start.left(10), &ok);
+        if (!ok) return false;
+        firstDay = TimestampParser::toDate(secs);
+    }
+    if (!filter.endTime.isEmpty()) {
+        QStringView end(filter.endTime);
+        if (!end.endsWith(u" 23:59:59")) return false;
+        bool ok = false;
+        qint64 secs = TimestampParser::parse(end.left(10), &ok);
+        if (!ok) return false;
+        lastDay = TimestampParser::toDate(secs);
+    }
+    return true;
+}
+
+QList<AccountRecord> AccountManager::recordsBefore(const QList<int>& recordIds) {
+    QList<AccountRecord> records;
+    if (recordIds.isEmpty()) return records;
+
+    QStringList placeholders;
+    QVariantList params;
+    for (int id : recordIds) {
+        placeholders << "?";
+        params << id;
+    }
+    QString sql = QString("SELECT %1 FROM account_record WHERE id IN (%2)")
+                      .arg(RecordRow::selectColumns(), placeholders.join(", "));
+    SqliteHelper::CachedQuery query = m_dbHelper->executeQueryWithParams(sql, params);
+    RecordRow row(query);
+    while (query.next()) {
+        records.append(row.toRecord());
+    }
+    query.finish();
     return records;
 }
 
+void AccountManager::refreshDerived(const QList<AccountRecord>& before, const QList<AccountRecord>& after,
+                                    qint64 generationBefore, qint64 generationAfter) {
+    // 写入前后所在的日期都要刷新（修改日期时记录从一天移到另一天）
+    QList<QPair<int, QDate>> days;
+    for (const QList<AccountRecord>* records : {&before, &after}) {
+        for (const AccountRecord& record : *records) {
+            bool ok = false;
+            qint64 secs = record.getBillTimestamp(&ok);
+            if (record.getUserId() > 0 && ok) {
+                days.append({record.getUserId(), TimestampParser::toDate(secs)});
+            }
+        }
+    }
+    RangeSumIndex::getInstance()->refreshDays(days, generationBefore, generationAfter);
+    BudgetManager::getInstance()->applyRecordChanges(before, after, generationBefore, generationAfter);
+}
+
+void AccountManager::writeThroughRecords(const QList<int>& recordIds, qint64 generationBefore,
+                                         qint64 generationAfter, const QList<AccountRecord>& before) {
+    // 期间有其他线程写入时不做写穿透，缓存在下次读取时按计数发现过期
+    if (recordIds.isEmpty() || generationAfter < 0) return;
+
+    // 按主键读回写入后的行，缓存与数据库逐列一致
+    QStringList placeholders;
+    QVariantList params;
+    for (int id : recordIds) {
+        placeholders << "?";
+        params << id;
+    }
+    QString sql = QString("SELECT %1 FROM account_record WHERE id IN (%2)")
+                      .arg(RecordRow::selectColumns(), placeholders.join(", "));
+    SqliteHelper::CachedQuery query = m_dbHelper->executeQueryWithParams(sql, params);
+
+    QList<AccountRecord> records;
+    QSet<int> found;
+    RecordRow row(query);
+    while (query.next()) {
+        records.append(row.toRecord());
+        found.insert(records.last().getId());
+    }
+    query.finish();
+
+    // 读不到的记录已被删除，按删除处理
+    for (int id : recordIds) {
+        if (found.contains(id)) continue;
+        AccountRecord removed;
+        removed.setId(id);
+        removed.setIsDeleted(1);
+        records.append(removed);
+    }
+    MonthCache::getInstance()->upsertRecords(records, generationBefore, generationAfter);
+    refreshDerived(before, records, generationBefore, generationAfter);
+}
+
+bool AccountManager::useFullTextSearch(const QString& keyword) {
+    return keyword.size() >= 3 && SqliteHelper::getInstance()->hasFullTextIndex();
+}
+
+QString AccountManager::fullTextPhrase(const QString& keyword) {
+    QString phrase = keyword;
+    phrase.replace("\"", "\"\"");
+    return "\"" + phrase + "\"";
+}
+
 //按日期范围查询
 QList<AccountRecord> AccountManager::queryRecordsByDateRange(int userId,
                                                              const QDate& startDate,
@@ -227,8 +624,174 @@ QList<AccountRecord> AccountManager::queryRecordsByType(int userId,
 QList<AccountRecord> AccountManager::queryMonthlyRecords(int userId, int year, int month, bool isDeleted) {
     QDate firstDayOfMonth(year, month, 1);
     QDate lastDayOfMonth = firstDayOfMonth.addMonths(1).addDays(-1);
+    if (isDeleted) {
+        return queryRecordsByDateRange(userId, firstDayOfMonth, lastDayOfMonth, isDeleted);
+    }
+
+    // 未删除记录走月度缓存，命中时不访问数据库
+    QList<AccountRecord> records;
+    if (MonthCache::getInstance()->lookup(userId, year, month, records)) {
+        return records;
+    }
+    return loadMonthlyRecords(userId, year, month);
+}
+
+QList<AccountRecord> AccountManager::loadMonthlyRecords(int userId, int year, int month) {
+    QDate firstDayOfMonth(year, month, 1);
+    RecordFilter filter;
+    filter.startTime = firstDayOfMonth.toString("yyyy-MM-dd 00:00:00");
+    filter.endTime = firstDayOfMonth.addMonths(1).addDays(-1).toString("yyyy-MM-dd 23:59:59");
+
+    QList<AccountRecord> records;
+    qint64 generation = m_dbHelper->recordGeneration();
+    int count = forEachRecord(userId, filter, [&records](const RecordRow& row) {
+        records.append(row.toRecord());
+        return true;
+    });
+    if (count >= 0) {
+        MonthCache::getInstance()->insert(userId, year, month, records, generation);
+    }
+    return records;
+}
+
+RecordPage AccountManager::queryMonthlyPage(int userId, int year, int month,
+                                            const RecordCursor& after, int pageSize) {
+    RecordPage page;
+    pageSize = qBound(1, pageSize, 500);
+    const QList<AccountRecord> records = queryMonthlyRecords(userId, year, month);
+
+    // 整月记录已按 (create_time, id) 倒序排列，二分定位游标之后的第一条
+    auto begin = records.cbegin();
+    if (after.isValid()) {
+        AccountRecord key;
+        key.setCreateTime(after.createTime);
+        key.setId(after.id);
+        begin = std::upper_bound(records.cbegin(), records.cend(), key, &MonthCache::isNewer);
+    }
+    for (auto it = begin; it != records.cend(); ++it) {
+        if (page.records.size() == pageSize) {
+            page.hasMore = true;
+            break;
+        }
+        page.records.append(*it);
+    }
+
+    if (!page.records.isEmpty()) {
+        page.nextCursor.createTime = page.records.last().getCreateTime();
+        page.nextCursor.id = page.records.last().getId();
+    }
+    return page;
+}
+
+// ============ 按日期范围的合计 ============
+bool AccountManager::getPeriodSummary(int userId, const QDate& firstDay, const QDate& lastDay,
+                                      double& totalIncome, double& totalExpense) {
+    totalIncome = 0.0;
+    totalExpense = 0.0;
+
+    RangeSumIndex::RangeSum sum;
+    if (RangeSumIndex::getInstance()->rangeSum(userId, firstDay, lastDay, sum)) {
+        totalIncome = RecordColumns::toYuan(sum.incomeCents);
+        totalExpense = RecordColumns::toYuan(sum.expenseCents);
+        return true;
+    }
+
+    // 索引不可用时沿 daily_rollup 主键 (user_id, day, ...) 的范围读取，每天每个分类一行
+    QString sql = "SELECT COALESCE(SUM(CASE WHEN type = 1 THEN sum_cents END), 0), "
+                  "COALESCE(SUM(CASE WHEN type = 0 THEN -sum_cents END), 0) "
+                  "FROM daily_rollup WHERE user_id = ? AND day >= ? AND day <= ?";
+    QVariantList params;
+    params << userId << firstDay.toString("yyyy-MM-dd") << lastDay.toString("yyyy-MM-dd");
+    SqliteHelper::CachedQuery query = m_dbHelper->executeQueryWithParams(sql, params);
+    if (!query.next()) {
+        return false;
+    }
+    totalIncome = RecordColumns::toYuan(query.value(0).toLongLong());
+    totalExpense = RecordColumns::toYuan(query.value(1).toLongLong());
+    query.finish();
+    return true;
+}
+
+void AccountManager::getMonthlySummary(int userId, int year, int month,
+                                       double& totalIncome, double& totalExpense) {
+    QDate firstDay(year, month, 1);
+    getPeriodSummary(userId, firstDay, firstDay.addMonths(1).addDays(-1), totalIncome, totalExpense);
+}
+
+void AccountManager::getYearlySummary(int userId, int year, double& totalIncome, double& totalExpense) {
+    getPeriodSummary(userId, QDate(year, 1, 1), QDate(year, 12, 31), totalIncome, totalExpense);
+}
 
-    return queryRecordsByDateRange(userId, firstDayOfMonth, lastDayOfMonth, isDeleted);
+bool AccountManager::queryMonthlyTotals(int userId, int year, int month, MonthlyTotals& totals) {
+    totals = MonthlyTotals();
+    QDate firstDayOfMonth(year, month, 1);
+    QVariantList params;
+    params << userId << firstDayOfMonth.toString("yyyy-MM-dd")
+           << firstDayOfMonth.addMonths(1).addDays(-1).toString("yyyy-MM-dd");
+
+    SqliteHelper::CachedQuery daily = m_dbHelper->executeQueryWithParams(monthlyTotalsSql(false), params);
+    if (!daily.isActive()) {
+        return false;
+    }
+    while (daily.next()) {
+        totals.days.append({daily.value(0).toInt(), daily.value(1).toLongLong(), daily.value(2).toLongLong()});
+    }
+    daily.finish();
+
+    SqliteHelper::CachedQuery category = m_dbHelper->executeQueryWithParams(monthlyTotalsSql(true), params);
+    if (!category.isActive()) {
+        return false;
+    }
+    while (category.next()) {
+        totals.categories.append({category.value(0).toString(), category.value(1).toLongLong(), category.value(2).toLongLong()});
+    }
+    category.finish();
+    return true;
+}
+
+QString AccountManager::monthlyTotalsSql(bool byCategory) {
+    // daily_rollup 中的金额已是按分逐条四舍五入后的整数合计，与 RecordColumns 的汇总结果一致
+    return QString("SELECT %1, "
+                   "COALESCE(SUM(CASE WHEN type = 1 THEN sum_cents END), 0), "
+                   "COALESCE(SUM(CASE WHEN type = 0 THEN -sum_cents END), 0) "
+                   "FROM daily_rollup WHERE user_id = ? AND day >= ? AND day <= ? GROUP BY 1")
+        .arg(byCategory ? "category" : "CAST(substr(day, 9, 2) AS INTEGER)");
+}
+
+bool AccountManager::queryPeriodTotals(int userId, const QDate& firstDay, const QDate& lastDay,
+                                       PeriodGranularity granularity, QList<PeriodCategoryTotal>& totals) {
+    totals.clear();
+    QVariantList params;
+    params << userId << firstDay.toString("yyyy-MM-dd") << lastDay.toString("yyyy-MM-dd");
+    SqliteHelper::CachedQuery query = m_dbHelper->executeQueryWithParams(periodTotalsSql(granularity), params);
+    if (!query.isActive()) {
+        return false;
+    }
+    while (query.next()) {
+        bool ok = false;
+        qint64 secs = TimestampParser::parse(query.value(0).toString(), &ok);
+        if (!ok) continue;   // create_time 不是日期格式的记录不参与按周期的合计
+        totals.append({TimestampParser::toDate(secs), query.value(1).toString(),
+                       query.value(2).toLongLong(), query.value(3).toLongLong()});
+    }
+    query.finish();
+    return true;
+}
+
+QString AccountManager::periodTotalsSql(PeriodGranularity granularity) {
+    // 周期键为周期首日：周取当周周一（先到本周日再回退 6 天），月、年取首日
+    QString periodKey;
+    switch (granularity) {
+    case PeriodGranularity::Day: periodKey = "day"; break;
+    case PeriodGranularity::Week: periodKey = "date(day, 'weekday 0', '-6 days')"; break;
+    case PeriodGranularity::Month: periodKey = "substr(day, 1, 7) || '-01'"; break;
+    case PeriodGranularity::Year: periodKey = "substr(day, 1, 4) || '-01-01'"; break;
+    }
+    return QString("SELECT %1, category, "
+                   "COALESCE(SUM(CASE WHEN type = 1 THEN sum_cents END), 0), "
+                   "COALESCE(SUM(CASE WHEN type = 0 THEN -sum_cents END), 0) "
+                   "FROM daily_rollup WHERE user_id = ? AND day >= ? AND day <= ? "
+                   "GROUP BY 1, 2 ORDER BY 1").arg(periodKey);
 }
 
 // 获取记录总数
@@ -274,6 +837,13 @@ void AccountManager::syncEditRecordToServer(const AccountRecord& record) {
     }
 }
 
+void AccountManager::syncBatchEditRecordsToServer(const QList<AccountRecord>& records) {
+    TcpClient* client = TcpClient::getInstance();
+    if (client && client->isConnected()) {
+        client->batchEditRecords(records.first().getUserId(), records);
+    }
+}
+
 void AccountManager::syncDeleteRecordToServer(int recordId) {
     TcpClient* client = TcpClient::getInstance();
     if (client && client->isConnected()) {
@@ -4,9 +4,127 @@
 
 #include "account_record.h"
 #include "sqlite_helper.h"
+#include "record_columns.h"
 #include <QString>
 #include <QDateTime>
 #include <QList>
+#include <QVariantList>
+#include <QSqlQuery>
+#include <functional>
+
+// 记录筛选条件（分页查询与收支汇总共用）
+struct RecordFilter {
+    QString startTime;          // 起始时间（含），为空表示不限
+    QString endTime;            // 结束时间（含），为空表示不限
+    QString keyword;            // 匹配分类名、备注或描述，为空表示不限
+    bool isDeleted = false;
+};
+
+// 键集分页游标：上一页最后一条记录的 (create_time, id)，无效游标表示从第一页开始
+struct RecordCursor {
+    QString createTime;
+    int id = 0;
+
+    bool isValid() const { return id > 0; }
+};
+
+// 一页查询结果
+struct RecordPage {
+    QList<AccountRecord> records;
+    RecordCursor nextCursor;    // 传给下一次查询以获取下一页
+    bool hasMore = false;       // 之后是否还有记录
+};
+
+// 一页按相关度排序的搜索结果（相关度没有可比较的游标，按偏移翻页）
+struct SearchPage {
+    QList<AccountRecord> records;
+    int nextOffset = 0;         // 传给下一次搜索以获取下一页
+    bool hasMore = false;
+};
+
+// 整月按日、按分类的收支合计（单位：分，支出为正数），从每日汇总表 daily_rollup 读取
+struct DailyTotal {
+    int day = 0;                // 当月第几天
+    qint64 incomeCents = 0;
+    qint64 expenseCents = 0;
+};
+
+struct CategoryTotal {
+    QString category;
+    qint64 incomeCents = 0;
+    qint64 expenseCents = 0;
+};
+
+struct MonthlyTotals {
+    QList<DailyTotal> days;             // 只含有记录的日期
+    QList<CategoryTotal> categories;
+};
+
+// 按周期分组的粒度（周从周一开始）
+enum class PeriodGranularity {
+    Day,
+    Week,
+    Month,
+    Year
+};
+
+// 一个周期内一个分类的合计
+struct PeriodCategoryTotal {
+    QDate periodStart;          // 周期首日（不受查询范围截断）
+    QString category;
+    qint64 incomeCents = 0;
+    qint64 expenseCents = 0;
+};
+
+// 结果集中的当前行：列位置在构造时按列名解析一次，之后逐行按位置读取
+// 只在遍历期间有效，不要保存；查询只需包含调用方用到的列，缺少的列读出默认值
+class RecordRow {
+public:
+    explicit RecordRow(const QSqlQuery& query);
+
+    int id() const;
+    int userId() const;
+    double amount() const;
+    QString category() const;
+    QString remark() const;
+    QString voucherPath() const;
+    int isDeleted() const;
+    QString deleteTime() const;
+    QString createTime() const;
+    QString modifyTime() const;
+    // create_time 的秒数：取 bill_ts 列，结果集没有该列或值为空时解析 create_time
+    qint64 billTimestamp(bool* ok) const;
+
+    // 需要保留该行时再复制出完整记录
+    AccountRecord toRecord() const;
+
+    // 完整记录所需的列
+    static QString selectColumns();
+    // 收支汇总只需的列
+    static QString summaryColumns();
+
+private:
+    enum Column {
+        Id = 0,
+        UserId,
+        Amount,
+        Category,
+        Remark,
+        VoucherPath,
+        IsDeleted,
+        DeleteTime,
+        CreateTime,
+        ModifyTime,
+        BillTs,
+        ColumnCount
+    };
+
+    const QSqlQuery& m_query;
+    int m_pos[ColumnCount];
+};
+
+// 行回调：返回 false 时停止遍历
+using RecordVisitor = std::function<bool(const RecordRow& row)>;
 
 class AccountManager {
 public:
@@ -14,9 +132,11 @@ public:
 
     // 快速记账（返回新插入记录的ID，失败返回-1）
     int addAccountRecord(const AccountRecord& record);
+    // 批量记账：整批在一个事务中插入，返回与输入顺序一致的新记录ID，失败时整批回滚并返回空列表
+    QList<int> addAccountRecords(const QList<AccountRecord>& records);
     // 编辑单条记录
     bool editAccountRecord(const AccountRecord& record);
-    // 批量编辑记录
+    // 批量编辑记录（一个事务内完成，提交成功后整批同步到服务端）
     bool batchEditAccountRecord(const QList<AccountRecord>& records);
     // 软删除记录（移入回收站）
     bool deleteAccountRecord(int recordId);
@@ -31,6 +151,21 @@ public:
                                             double minAmount = 0,
                                             double maxAmount = 0,
                                             bool isDeleted = false);
+    // 键集分页查询：按 (create_time, id) 倒序，返回 after 之后的至多 pageSize 条记录
+    RecordPage queryAccountRecordPage(int userId,
+                                      const RecordFilter& filter,
+                                      const RecordCursor& after = RecordCursor(),
+                                      int pageSize = 50);
+    // 关键字搜索：有全文索引时按 bm25 相关度排序（分类权重最高），否则按时间倒序
+    SearchPage searchAccountRecords(int userId, const QString& keyword,
+                                    int offset = 0, int pageSize = 50);
+    // 流式遍历：逐行把结果交给 visitor，不生成中间列表，返回遍历的行数，出错返回 -1
+    // columns 为查询的列（默认完整记录），只做汇总时传 RecordRow::summaryColumns()
+    int forEachRecord(int userId, const RecordFilter& filter, const RecordVisitor& visitor,
+                      const QString& columns = RecordRow::selectColumns());
+    // 汇总筛选范围内的总收入和总支出（支出为正数）
+    bool getAmountSummary(int userId, const RecordFilter& filter,
+                          double& totalIncome, double& totalExpense);
     // 获取预设收支类型
     QStringList getPresetTypes();
     // 按日期范围查询
@@ -47,16 +182,57 @@ public:
     QList<AccountRecord> queryRecordsByType(int userId,
                                             const QString& type,
                                             bool isDeleted = false);
-    // 按月份查询
+    // 按月份查询（未删除记录经月度缓存，重复查询同一月份不访问数据库）
     QList<AccountRecord> queryMonthlyRecords(int userId, int year, int month, bool isDeleted = false);
+    // 从缓存的整月记录中按 (create_time, id) 倒序分页，游标与 queryAccountRecordPage 通用
+    RecordPage queryMonthlyPage(int userId, int year, int month,
+                                const RecordCursor& after = RecordCursor(), int pageSize = 50);
+    // ============ 按日期范围的合计（读取每日汇总表，不扫描记录） ============
+    // [firstDay, lastDay] 内未删除记录的总收入和总支出（支出为正数）
+    bool getPeriodSummary(int userId, const QDate& firstDay, const QDate& lastDay,
+                          double& totalIncome, double& totalExpense);
+    void getMonthlySummary(int userId, int year, int month, double& totalIncome, double& totalExpense);
+    void getYearlySummary(int userId, int year, double& totalIncome, double& totalExpense);
+    // 整月按日、按分类的收支合计，只取回汇总行，不读取记录也不放入月度缓存
+    bool queryMonthlyTotals(int userId, int year, int month, MonthlyTotals& totals);
+    // queryMonthlyTotals 的聚合语句，参数依次为 user_id、首日、末日（yyyy-MM-dd）
+    static QString monthlyTotalsSql(bool byCategory);
+    // [firstDay, lastDay] 内按周期、按分类的收支合计，一次分组查询取回全部周期，按周期首日升序
+    bool queryPeriodTotals(int userId, const QDate& firstDay, const QDate& lastDay,
+                           PeriodGranularity granularity, QList<PeriodCategoryTotal>& totals);
+    // queryPeriodTotals 的聚合语句，参数与 monthlyTotalsSql 相同
+    static QString periodTotalsSql(PeriodGranularity granularity);
     // 获取记录总数
     int getRecordCount(int userId, bool isDeleted = false);
 
 private:
     SqliteHelper* m_dbHelper = SqliteHelper::getInstance();
+    // 只更新本地数据库，不同步服务端
+    bool updateRecordLocal(const AccountRecord& record);
+    // 从数据库读取整月未删除记录并放入月度缓存
+    QList<AccountRecord> loadMonthlyRecords(int userId, int year, int month);
+    // 写入成功后读回这些记录并更新月度缓存；before 为写入前的这些记录，
+    // 与写入后的记录一起更新区间合计索引和预算计数；generationAfter 为 -1（期间有其他线程写入）时不做写穿透
+    void writeThroughRecords(const QList<int>& recordIds, qint64 generationBefore, qint64 generationAfter,
+                             const QList<AccountRecord>& before = {});
+    // 写入前读取这些记录（按主键，用于扣除旧值）
+    QList<AccountRecord> recordsBefore(const QList<int>& recordIds);
+    // 按写入前后的记录更新区间合计索引（按天刷新）和预算计数（按记录增减）
+    void refreshDerived(const QList<AccountRecord>& before, const QList<AccountRecord>& after,
+                        qint64 generationBefore, qint64 generationAfter);
+    // 筛选范围是否正好由整天组成（起始为零点或不限，结束为 23:59:59 或不限），是则给出首末日
+    static bool wholeDayRange(const RecordFilter& filter, QDate& firstDay, QDate& lastDay);
+    // 生成筛选条件的 WHERE 子句，参数依次追加到 params
+    static QString buildFilterCondition(int userId, const RecordFilter& filter, QVariantList& params);
+    // 关键字能否走全文索引（trigram 至少需要三个字）
+    static bool useFullTextSearch(const QString& keyword);
+    // 把关键字转成 FTS5 短语查询，避免其中的运算符被当作查询语法
+    static QString fullTextPhrase(const QString& keyword);
+
     // 将账单记录同步到服务端
     void syncRecordToServer(const AccountRecord& record);
     void syncEditRecordToServer(const AccountRecord& record);
+    void syncBatchEditRecordsToServer(const QList<AccountRecord>& records);
     void syncDeleteRecordToServer(int recordId);
     void syncRestoreRecordToServer(int recordId);
     void syncPermanentDeleteRecordToServer(int recordId);
@@ -1,5 +1,14 @@
 #include "account_record.h"
+#include "timestamp_parser.h"
 #include <QLabel>
 
 AccountRecord::AccountRecord(int userId, double amount, const QString& type, const QString& remark)
     : m_userId(userId), m_amount(amount), m_type(type), m_remark(remark) {}
+
+qint64 AccountRecord::getBillTimestamp(bool* ok) const {
+    if (m_billTimestamp != kUnparsedTimestamp) {
+        *ok = true;
+        return m_billTimestamp;
+    }
+    return TimestampParser::parse(m_createTime, ok);
+}
@@ -2,6 +2,7 @@
 #define ACCOUNT_RECORD_H
 
 #include <QString>
+#include <limits>
 
 class AccountRecord {
 public:
@@ -34,7 +35,12 @@ public:
     void setDeleteTime(const QString& time) { m_deleteTime = time; }
 
     QString getCreateTime() const { return m_createTime; }
-    void setCreateTime(const QString& time) { m_createTime = time; }
+    void setCreateTime(const QString& time) { m_createTime = time; m_billTimestamp = kUnparsedTimestamp; }
+
+    // 记账时间的秒数（见 TimestampParser）：优先使用数据库 bill_ts 列读出的值，否则解析 create_time；
+    // create_time 无法解析时 ok 为 false
+    qint64 getBillTimestamp(bool* ok) const;
+    void setBillTimestamp(qint64 secs) { m_billTimestamp = secs; }
 
     QString getModifyTime() const { return m_modifyTime; }
     void setModifyTime(const QString& time) { m_modifyTime = time; }
@@ -49,6 +55,8 @@ private:
     int m_isDeleted = 0;    // 0:正常 1:回收站
     QString m_deleteTime;   // 删除时间
     QString m_createTime;   // 创建时间
+    static constexpr qint64 kUnparsedTimestamp = std::numeric_limits<qint64>::min();
+    qint64 m_billTimestamp = kUnparsedTimestamp;  // 创建时间的秒数，未设置时按 m_createTime 解析
     QString m_modifyTime;   // 修改时间
 };
 
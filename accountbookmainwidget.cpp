@@ -6,6 +6,8 @@
 #include "account_manager.h"
 #include "user_manager.h"
 #include "sync_manager.h"
+#include "category_registry.h"
+#include "timestamp_parser.h"
 #include <QLabel>
 #include <QPushButton>
 #include <QComboBox>
@@ -27,6 +29,8 @@
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QMessageBox>
+#include <QFutureWatcher>
+#include <QScrollBar>
 
 #include <QPropertyAnimation>
 #include <QGraphicsDropShadowEffect>
@@ -157,57 +161,15 @@ private:
     Result m_result = Cancel;
 };
 
-// 静态辅助函数：解析日期时间字符串，支持多种格式
-static QDateTime parseDateTime(const QString& dateTimeStr) {
-    QDateTime dt = QDateTime::fromString(dateTimeStr, "yyyy-MM-dd HH:mm:ss");
-    if (!dt.isValid()) {
-        dt = QDateTime::fromString(dateTimeStr, "yyyy-MM-dd HH:mm");
+// 静态辅助函数：取记录的记账时间
+static QDateTime recordDateTime(const AccountRecord& record) {
+    // 优先使用读出的 bill_ts，不再解析时间文本；其余格式（带时区、毫秒等）按 ISO 8601 解析
+    bool ok = false;
+    qint64 secs = record.getBillTimestamp(&ok);
+    if (ok) {
+        return TimestampParser::toDateTime(secs);
     }
-    if (!dt.isValid()) {
-        dt = QDateTime::fromString(dateTimeStr, Qt::ISODate);
-    }
-    if (!dt.isValid()) {
-        // 如果还是无效，尝试只解析日期
-        QDate date = QDate::fromString(dateTimeStr, "yyyy-MM-dd");
-        if (date.isValid()) {
-            dt = QDateTime(date, QTime(0, 0));
-        }
-    }
-    return dt;
-}
-
-// 静态辅助函数：获取分类名称到拼音的映射（与 AccountBookRecordWidget 保持一致）
-static QMap<QString, QString> getCategoryPinyinMap() {
-    QMap<QString, QString> cateMap;
-    // 支出分类
-    cateMap["餐饮"] = "canyin";
-    cateMap["服饰"] = "fushi";
-    cateMap["日用"] = "riyong";
-    cateMap["数码"] = "shuma";
-    cateMap["美妆"] = "meizhuang";
-    cateMap["软件"] = "ruanjian";
-    cateMap["住房"] = "zhufang";
-    cateMap["交通"] = "jiaotong";
-    cateMap["娱乐"] = "yule";
-    cateMap["医疗"] = "yiliao";
-    cateMap["通讯"] = "tongxun";
-    cateMap["汽车"] = "qiche";
-    cateMap["学习"] = "xuexi";
-    cateMap["办公"] = "bangong";
-    cateMap["运动"] = "yundong";
-    cateMap["社交"] = "shejiao";
-    cateMap["宠物"] = "chongwu";
-    cateMap["旅行"] = "lvxing";
-    cateMap["育儿"] = "yuer";
-    cateMap["其他"] = "qita";
-    // 收入分类
-    cateMap["副业"] = "fuye";
-    cateMap["工资"] = "gongzi";
-    cateMap["红包"] = "hongbao";
-    cateMap["兼职"] = "jianzhi";
-    cateMap["投资"] = "touzi";
-    cateMap["意外收入"] = "yiwaishouru";
-    return cateMap;
+    return QDateTime::fromString(record.getCreateTime(), Qt::ISODate);
 }
 
 AccountBookMainWidget::AccountBookMainWidget(QWidget *parent)
@@ -359,6 +321,9 @@ void AccountBookMainWidget::initUI()
     emptyItem->setSizeHint(QSize(0, 320));
     m_billListWidget->setItemWidget(emptyItem, emptyWidget);
     mainLayout->addWidget(m_billListWidget);
+    // 滚动到底部附近时加载下一页
+    connect(m_billListWidget->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &AccountBookMainWidget::onBillListScrolled);
 
     // 连接账单点击信号，用于编辑或删除
     connect(m_billListWidget, &QListWidget::itemClicked, this, [this](QListWidgetItem *item){
@@ -482,176 +447,188 @@ void AccountBookMainWidget::updateStatistic(double totalExpense, double totalInc
 // ========== 新增：批量更新账单列表（核心动态函数） ==========
 void AccountBookMainWidget::updateBillData(const QList<AccountRecord>& records)
 {
-    m_billListWidget->clear();
+    resetBillList();
 
     if (records.isEmpty()) {
-        QListWidgetItem *emptyItem = new QListWidgetItem(m_billListWidget);
-        QWidget *emptyWidget = new QWidget();
-        emptyWidget->setMinimumHeight(350); 
-        
-        QLabel *emptyLabel = new QLabel("本月暂无数据");
-        emptyLabel->setStyleSheet("color: #999; font-size: 16px; font-weight: 500;");
-        emptyLabel->setAlignment(Qt::AlignCenter);
-        
-        QVBoxLayout *emptyLayout = new QVBoxLayout(emptyWidget);
-        emptyLayout->addStretch(1);
-        emptyLayout->addWidget(emptyLabel);
-        emptyLayout->addStretch(1);
-        
-        emptyItem->setSizeHint(QSize(0, 350));
-        emptyItem->setFlags(Qt::NoItemFlags); // 不可交互
-        m_billListWidget->setItemWidget(emptyItem, emptyWidget);
+        showEmptyBillList();
         updateStatistic(0, 0);
         return;
     }
 
-    // 按日期分组
-    QMap<QString, QList<AccountRecord>> groupedBills;
-    QStringList dateOrder; // 保持日期顺序
     double totalExpense = 0.0;
     double totalIncome = 0.0;
-
     for (const AccountRecord& record : records) {
-        QDateTime dt = parseDateTime(record.getCreateTime());
-        QString dateKey = dt.isValid() ? (dt.toString("MM/dd ") + dt.date().toString("ddd")) : "未知日期";
-        
-        if (!groupedBills.contains(dateKey)) {
-            dateOrder.append(dateKey);
-        }
-        groupedBills[dateKey].append(record);
-        
         double amount = record.getAmount();
         if (amount < 0) totalExpense += qAbs(amount);
         else totalIncome += amount;
     }
 
-    // 获取分类图标映射
-    static QMap<QString, QString> pinyinMap = getCategoryPinyinMap();
-
-    // 渲染分组数据
-    for (const QString& date : dateOrder) {
-        // 1. 添加日期抬头
-        QListWidgetItem *headerItem = new QListWidgetItem(m_billListWidget);
-        QWidget *headerWidget = new QWidget();
-        headerWidget->setStyleSheet("background-color: transparent;");
-        QHBoxLayout *headerLayout = new QHBoxLayout(headerWidget);
-        headerLayout->setContentsMargins(15, 10, 15, 5);
-
-        QLabel *dateLabel = new QLabel(date);
-        dateLabel->setStyleSheet("color: #999; font-size: 13px; font-weight: bold;");
-        headerLayout->addWidget(dateLabel);
-        headerLayout->addStretch();
-
-        // 计算该日支出
-        double dayExpense = 0;
-        for (const AccountRecord& r : groupedBills[date]) {
-            if (r.getAmount() < 0) dayExpense += qAbs(r.getAmount());
-        }
-        if (dayExpense > 0) {
-            QLabel *dayStatLabel = new QLabel(QString("支出: ¥%1").arg(QString::number(dayExpense, 'f', 2)));
+    appendBillRecords(records);
+    updateStatistic(totalExpense, totalIncome);
+}
+
+void AccountBookMainWidget::resetBillList()
+{
+    m_billListWidget->clear();
+    m_lastDateKey.clear();
+    m_dayExpense.clear();
+    m_dayStatLabels.clear();
+}
+
+void AccountBookMainWidget::showEmptyBillList()
+{
+    QListWidgetItem *emptyItem = new QListWidgetItem(m_billListWidget);
+    QWidget *emptyWidget = new QWidget();
+    emptyWidget->setMinimumHeight(350); 
+    
+    QLabel *emptyLabel = new QLabel(m_searchKeyword.isEmpty() ? "本月暂无数据" : "没有匹配的账单");
+    emptyLabel->setStyleSheet("color: #999; font-size: 16px; font-weight: 500;");
+    emptyLabel->setAlignment(Qt::AlignCenter);
+    
+    QVBoxLayout *emptyLayout = new QVBoxLayout(emptyWidget);
+    emptyLayout->addStretch(1);
+    emptyLayout->addWidget(emptyLabel);
+    emptyLayout->addStretch(1);
+    
+    emptyItem->setSizeHint(QSize(0, 350));
+    emptyItem->setFlags(Qt::NoItemFlags); // 不可交互
+    m_billListWidget->setItemWidget(emptyItem, emptyWidget);
+}
+
+void AccountBookMainWidget::appendBillRecords(const QList<AccountRecord>& records)
+{
+    CategoryRegistry* registry = CategoryRegistry::getInstance();
+
+    // 记录已按时间倒序排列，日期变化时插入新的日期抬头
+    for (const AccountRecord& record : records) {
+        QDateTime recordTime = recordDateTime(record);
+        QString dateKey = recordTime.isValid() ? (recordTime.toString("MM/dd ") + recordTime.date().toString("ddd")) : "未知日期";
+
+        if (dateKey != m_lastDateKey && !m_dayStatLabels.contains(dateKey)) {
+            // 1. 添加日期抬头
+            QListWidgetItem *headerItem = new QListWidgetItem(m_billListWidget);
+            QWidget *headerWidget = new QWidget();
+            headerWidget->setStyleSheet("background-color: transparent;");
+            QHBoxLayout *headerLayout = new QHBoxLayout(headerWidget);
+            headerLayout->setContentsMargins(15, 10, 15, 5);
+
+            QLabel *dateLabel = new QLabel(dateKey);
+            dateLabel->setStyleSheet("color: #999; font-size: 13px; font-weight: bold;");
+            headerLayout->addWidget(dateLabel);
+            headerLayout->addStretch();
+
+            // 该日支出随后续页面累加，没有支出时隐藏
+            QLabel *dayStatLabel = new QLabel();
             dayStatLabel->setStyleSheet("color: #999; font-size: 12px;");
+            dayStatLabel->hide();
             headerLayout->addWidget(dayStatLabel);
+            m_dayStatLabels.insert(dateKey, dayStatLabel);
+
+            headerItem->setSizeHint(headerWidget->sizeHint());
+            headerItem->setFlags(headerItem->flags() & ~Qt::ItemIsSelectable); // 抬头不可选中
+            m_billListWidget->setItemWidget(headerItem, headerWidget);
         }
+        m_lastDateKey = dateKey;
 
-        headerItem->setSizeHint(headerWidget->sizeHint());
-        headerItem->setFlags(headerItem->flags() & ~Qt::ItemIsSelectable); // 抬头不可选中
-        m_billListWidget->setItemWidget(headerItem, headerWidget);
-
-        // 2. 添加该日期下的所有账单项
-        for (const AccountRecord& record : groupedBills[date]) {
-            double amount = qAbs(record.getAmount());
-            bool isExpense = (record.getAmount() < 0);
-            QString cateName = record.getType();
-            QDateTime dt = parseDateTime(record.getCreateTime());
-            QString timeStr = dt.isValid() ? dt.toString("HH:mm") : "--:--";
-
-            QListWidgetItem *item = new QListWidgetItem(m_billListWidget);
-            // 存储记录ID，用于点击跳转编辑
-            item->setData(Qt::UserRole, record.getId());
-            // 存储完整记录 JSON，方便直接获取（如果数据量不大）
-            QJsonObject obj;
-            obj["id"] = record.getId();
-            obj["userId"] = record.getUserId();
-            obj["amount"] = record.getAmount();
-            obj["type"] = record.getType();
-            obj["remark"] = record.getRemark();
-            obj["createTime"] = record.getCreateTime();
-            item->setData(Qt::UserRole + 1, QJsonDocument(obj).toJson());
-            
-            // 外层容器，负责边距
-            QWidget *container = new QWidget();
-            container->setAttribute(Qt::WA_TransparentForMouseEvents); // 让鼠标事件穿透到 QListWidget
-            QVBoxLayout *containerLayout = new QVBoxLayout(container);
-            containerLayout->setContentsMargins(15, 4, 15, 4);
-            
-            // 内层卡片，负责背景和样式
-            QWidget *itemWidget = new QWidget();
-            itemWidget->setObjectName("billItemWidget");
-            QHBoxLayout *itemLayout = new QHBoxLayout(itemWidget);
-            itemLayout->setContentsMargins(12, 10, 12, 10);
-            itemLayout->setSpacing(12);
-
-            // 图标
-            QLabel *iconLabel = new QLabel();
-            iconLabel->setFixedSize(40, 40);
-            QString pinyin = pinyinMap.value(cateName, "qita");
-            QString imgDir = isExpense ? "classify1" : "classify2";
-            QString iconPath = QString(":/%1/resources/%2/%3.jpg").arg(imgDir).arg(imgDir).arg(pinyin);
-            
-            if (QFile::exists(iconPath)) {
-                QPixmap pix(iconPath);
-                iconLabel->setPixmap(pix.scaled(40, 40, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-                iconLabel->setStyleSheet("border-radius: 20px; overflow: hidden; background-color: #F8F8F8;");
-            } else {
-                iconLabel->setText(cateName.left(1));
-                iconLabel->setAlignment(Qt::AlignCenter);
-                iconLabel->setStyleSheet(QString("background-color: %1; border-radius: 20px; color: white; font-weight: bold;")
-                                         .arg(isExpense ? "#FF6B6B" : "#4CAF50"));
-            }
-            itemLayout->addWidget(iconLabel);
-
-            // 信息列
-            QVBoxLayout *infoLayout = new QVBoxLayout();
-            infoLayout->setSpacing(2);
-            
-            QHBoxLayout *nameRow = new QHBoxLayout();
-            nameRow->setSpacing(8);
-            
-            QLabel *nameLabel = new QLabel(cateName);
-            nameLabel->setStyleSheet("font-size: 14px; font-weight: bold; color: #333;");
-            nameRow->addWidget(nameLabel);
-            
-            QString remark = record.getRemark();
-            if (!remark.isEmpty()) {
-                QLabel *remarkLabel = new QLabel("(" + remark + ")");
-                remarkLabel->setStyleSheet("font-size: 12px; color: #666; font-style: italic;");
-                nameRow->addWidget(remarkLabel);
-            }
-            nameRow->addStretch();
-            
-            infoLayout->addLayout(nameRow);
-
-            QLabel *timeLabel = new QLabel(timeStr);
-            timeLabel->setStyleSheet("font-size: 11px; color: #999;");
-            infoLayout->addWidget(timeLabel);
-            itemLayout->addLayout(infoLayout);
-
-            itemLayout->addStretch();
-
-            // 金额
-            QLabel *amountLabel = new QLabel(QString("%1%2").arg(isExpense ? "-" : "+", 
-                                             QString::number(amount, 'f', 2)));
-            amountLabel->setStyleSheet(QString("font-size: 16px; font-weight: bold; color: %1;")
-                                        .arg(isExpense ? "#333" : "#4CAF50"));
-            itemLayout->addWidget(amountLabel);
-
-            containerLayout->addWidget(itemWidget);
-            item->setSizeHint(container->sizeHint());
-            m_billListWidget->setItemWidget(item, container);
+        if (record.getAmount() < 0) {
+            double dayExpense = (m_dayExpense[dateKey] += qAbs(record.getAmount()));
+            QLabel *dayStatLabel = m_dayStatLabels.value(dateKey);
+            dayStatLabel->setText(QString("支出: ¥%1").arg(QString::number(dayExpense, 'f', 2)));
+            dayStatLabel->show();
         }
-    }
 
-    updateStatistic(totalExpense, totalIncome);
+        // 2. 添加账单项
+        double amount = qAbs(record.getAmount());
+        bool isExpense = (record.getAmount() < 0);
+        QString cateName = record.getType();
+        QString timeStr = recordTime.isValid() ? recordTime.toString("HH:mm") : "--:--";
+
+        QListWidgetItem *item = new QListWidgetItem(m_billListWidget);
+        // 存储记录ID，用于点击跳转编辑
+        item->setData(Qt::UserRole, record.getId());
+        // 存储完整记录 JSON，方便直接获取（如果数据量不大）
+        QJsonObject obj;
+        obj["id"] = record.getId();
+        obj["userId"] = record.getUserId();
+        obj["amount"] = record.getAmount();
+        obj["type"] = record.getType();
+        obj["remark"] = record.getRemark();
+        obj["createTime"] = record.getCreateTime();
+        item->setData(Qt::UserRole + 1, QJsonDocument(obj).toJson());
+        
+        // 外层容器，负责边距
+        QWidget *container = new QWidget();
+        container->setAttribute(Qt::WA_TransparentForMouseEvents); // 让鼠标事件穿透到 QListWidget
+        QVBoxLayout *containerLayout = new QVBoxLayout(container);
+        containerLayout->setContentsMargins(15, 4, 15, 4);
+        
+        // 内层卡片，负责背景和样式
+        QWidget *itemWidget = new QWidget();
+        itemWidget->setObjectName("billItemWidget");
+        QHBoxLayout *itemLayout = new QHBoxLayout(itemWidget);
+        itemLayout->setContentsMargins(12, 10, 12, 10);
+        itemLayout->setSpacing(12);
+
+        // 图标
+        QLabel *iconLabel = new QLabel();
+        iconLabel->setFixedSize(40, 40);
+        // 图标文件名取自分类注册表，没有配置图标的分类使用“其他”的图标
+        QString pinyin = registry->icon(registry->intern(cateName));
+        if (pinyin.isEmpty()) pinyin = "qita";
+        QString imgDir = isExpense ? "classify1" : "classify2";
+        QString iconPath = QString(":/%1/resources/%2/%3.jpg").arg(imgDir).arg(imgDir).arg(pinyin);
+        
+        if (QFile::exists(iconPath)) {
+            QPixmap pix(iconPath);
+            iconLabel->setPixmap(pix.scaled(40, 40, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+            iconLabel->setStyleSheet("border-radius: 20px; overflow: hidden; background-color: #F8F8F8;");
+        } else {
+            iconLabel->setText(cateName.left(1));
+            iconLabel->setAlignment(Qt::AlignCenter);
+            iconLabel->setStyleSheet(QString("background-color: %1; border-radius: 20px; color: white; font-weight: bold;")
+                                     .arg(isExpense ? "#FF6B6B" : "#4CAF50"));
+        }
+        itemLayout->addWidget(iconLabel);
+
+        // 信息列
+        QVBoxLayout *infoLayout = new QVBoxLayout();
+        infoLayout->setSpacing(2);
+        
+        QHBoxLayout *nameRow = new QHBoxLayout();
+        nameRow->setSpacing(8);
+        
+        QLabel *nameLabel = new QLabel(cateName);
+        nameLabel->setStyleSheet("font-size: 14px; font-weight: bold; color: #333;");
+        nameRow->addWidget(nameLabel);
+        
+        QString remark = record.getRemark();
+        if (!remark.isEmpty()) {
+            QLabel *remarkLabel = new QLabel("(" + remark + ")");
+            remarkLabel->setStyleSheet("font-size: 12px; color: #666; font-style: italic;");
+            nameRow->addWidget(remarkLabel);
+        }
+        nameRow->addStretch();
+        
+        infoLayout->addLayout(nameRow);
+
+        QLabel *timeLabel = new QLabel(timeStr);
+        timeLabel->setStyleSheet("font-size: 11px; color: #999;");
+        infoLayout->addWidget(timeLabel);
+        itemLayout->addLayout(infoLayout);
+
+        itemLayout->addStretch();
+
+        // 金额
+        QLabel *amountLabel = new QLabel(QString("%1%2").arg(isExpense ? "-" : "+", 
+                                         QString::number(amount, 'f', 2)));
+        amountLabel->setStyleSheet(QString("font-size: 16px; font-weight: bold; color: %1;")
+                                    .arg(isExpense ? "#333" : "#4CAF50"));
+        itemLayout->addWidget(amountLabel);
+
+        containerLayout->addWidget(itemWidget);
+        item->setSizeHint(container->sizeHint());
+        m_billListWidget->setItemWidget(item, container);
+    }
 }
 
 void AccountBookMainWidget::onPrevMonth()
@@ -684,15 +661,84 @@ void AccountBookMainWidget::updateDateDisplay()
 }
 
 void AccountBookMainWidget::loadBillsForMonth()
+{
+    requestBillPage(true);
+}
+
+void AccountBookMainWidget::requestBillPage(bool firstPage)
 {
     int userId = UserManager::getInstance()->getCurrentUser().getId();
     if (userId <= 0) {
         qDebug() << "未登录用户，无法加载账单";
         return;
     }
+    if (!firstPage && (!m_billHasMore || m_billPageLoading)) return;
+
+    // 当月范围内按关键字筛选，每次只取一页；不带关键字时从月度缓存分页
+    int year = m_currentDate.year();
+    int month = m_currentDate.month();
+    RecordFilter filter;
+    filter.startTime = QDate(year, month, 1).toString("yyyy-MM-dd 00:00:00");
+    filter.endTime = QDate(year, month, 1).addMonths(1).addDays(-1).toString("yyyy-MM-dd 23:59:59");
+    filter.keyword = m_searchKeyword;
+    RecordCursor after = firstPage ? RecordCursor() : m_billCursor;
+
+    // 在数据库线程池中查询，避免卡住界面
+    int requestId = firstPage ? ++m_billLoadSeq : m_billLoadSeq;
+    if (firstPage) m_billLoadFuture.cancel();  // 尚未开始的旧请求直接取消
+    m_billPageLoading = true;
+    m_billLoadFuture = SqliteHelper::getInstance()->runAsync<BillPageLoad>([userId, year, month, filter, after, firstPage]() {
+        AccountManager accountManager;
+        BillPageLoad load;
+        if (filter.keyword.isEmpty()) {
+            load.page = accountManager.queryMonthlyPage(userId, year, month, after);
+            if (firstPage) {
+                accountManager.getMonthlySummary(userId, year, month, load.totalIncome, load.totalExpense);
+                load.hasTotals = true;
+            }
+            return load;
+        }
+        load.page = accountManager.queryAccountRecordPage(userId, filter, after);
+        // 统计卡片展示整月合计，只在加载首页时汇总一次
+        if (firstPage) {
+            load.hasTotals = accountManager.getAmountSummary(userId, filter, load.totalIncome, load.totalExpense);
+        }
+        return load;
+    });
+
+    auto *watcher = new QFutureWatcher<BillPageLoad>(this);
+    connect(watcher, &QFutureWatcher<BillPageLoad>::finished, this, [this, watcher, requestId, firstPage]() {
+        watcher->deleteLater();
+        // 期间已切换月份、修改搜索或重新加载，丢弃过期结果
+        if (requestId != m_billLoadSeq || watcher->isCanceled()) return;
+        m_billPageLoading = false;
+
+        BillPageLoad load = watcher->result();
+        m_billCursor = load.page.nextCursor;
+        m_billHasMore = load.page.hasMore;
+
+        if (firstPage) {
+            resetBillList();
+            if (load.page.records.isEmpty()) showEmptyBillList();
+            updateStatistic(load.totalExpense, load.totalIncome);
+        }
+        appendBillRecords(load.page.records);
+
+        // 首页不足以填满列表时继续加载，保证可以滚动触发后续分页
+        if (m_billHasMore && m_billListWidget->verticalScrollBar()->maximum() == 0) {
+            requestBillPage(false);
+        }
+    });
+    watcher->setFuture(m_billLoadFuture);
+}
 
-    QList<AccountRecord> records = BillService::getMonthlyBills(userId, m_currentDate);
-    updateBillData(records);
+void AccountBookMainWidget::onBillListScrolled(int value)
+{
+    // 接近底部时加载下一页
+    QScrollBar *bar = m_billListWidget->verticalScrollBar();
+    if (value >= bar->maximum() - bar->pageStep() / 2) {
+        requestBillPage(false);
+    }
 }
 
 bool AccountBookMainWidget::eventFilter(QObject *watched, QEvent *event)
@@ -706,27 +752,9 @@ bool AccountBookMainWidget::eventFilter(QObject *watched, QEvent *event)
 
 void AccountBookMainWidget::onSearchTextChanged(const QString &text)
 {
-    int userId = UserManager::getInstance()->getCurrentUser().getId();
-    if (userId <= 0) return;
-
-    // 获取当月所有账单
-    QList<AccountRecord> records = BillService::getMonthlyBills(userId, m_currentDate);
-    QList<AccountRecord> filteredList;
-
-    QString keyword = text.trimmed().toLower();
-
-    for (const AccountRecord& record : records) {
-        // 搜索分类名或备注
-        QString category = record.getType().toLower();
-        QString remark = record.getRemark().toLower();
-
-        if (keyword.isEmpty() || category.contains(keyword) || remark.contains(keyword)) {
-            filteredList.append(record);
-        }
-    }
-
-    // 更新列表显示
-    updateBillData(filteredList);
+    // 搜索分类名或备注：交给数据库在当月范围内匹配，结果同样分页加载
+    m_searchKeyword = text.trimmed();
+    loadBillsForMonth();
 }
 
 void AccountBookMainWidget::onNavButtonClicked()
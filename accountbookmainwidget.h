@@ -13,8 +13,18 @@
 #include <QDate>
 #include <QScrollArea>
 #include <QStackedWidget>
+#include <QFuture>
 #include "settings_widget.h"
 #include "statistics_widget.h"
+#include "account_manager.h"
+
+// 后台加载的一页账单，首页附带筛选范围内的收支合计
+struct BillPageLoad {
+    RecordPage page;
+    bool hasTotals = false;
+    double totalIncome = 0.0;
+    double totalExpense = 0.0;
+};
 
 class AccountBookMainWidget : public QWidget
 {
@@ -30,6 +40,7 @@ private slots:
     void onMonthLabelClicked();
     void onSearchTextChanged(const QString &text);
     void onNavButtonClicked();
+    void onBillListScrolled(int value);
 
 protected:
     bool eventFilter(QObject *watched, QEvent *event) override;
@@ -39,6 +50,13 @@ private:
     void initStyleSheet();
     void updateDateDisplay();
     void loadBillsForMonth();
+    // 请求一页账单：firstPage 为 true 时从头加载并重置列表
+    void requestBillPage(bool firstPage);
+    // 清空列表及分组状态
+    void resetBillList();
+    void showEmptyBillList();
+    // 将一页记录按日期分组追加到列表末尾
+    void appendBillRecords(const QList<AccountRecord>& records);
 
     // 工具函数 - 创建单个账单项（核心动态生成逻辑）
     QWidget* createBillItemWidget(const QString& date, const QString& cateIcon,
@@ -49,6 +67,19 @@ private:
 
     QDate m_currentDate; // 当前显示的月份
 
+    // 后台分页加载账单：序号用于丢弃过期结果
+    int m_billLoadSeq = 0;
+    QFuture<BillPageLoad> m_billLoadFuture;
+    RecordCursor m_billCursor;         // 下一页的起点
+    bool m_billHasMore = false;
+    bool m_billPageLoading = false;
+    QString m_searchKeyword;           // 当前搜索关键字（分类/备注）
+
+    // 已渲染的日期分组：追加下一页时同一天的记录接在原分组下
+    QString m_lastDateKey;
+    QMap<QString, double> m_dayExpense;
+    QMap<QString, QLabel*> m_dayStatLabels;
+
     // 界面堆栈
     QStackedWidget *m_stackedWidget;
     QWidget *m_bookPage;
@@ -1,6 +1,8 @@
 #include "accountbookrecordwidget.h"
 #include "bill_service.h"
 #include "budget_manager.h"
+#include "category_registry.h"
+#include "timestamp_parser.h"
 #include <QDebug>
 #include <QFont>
 #include <QVBoxLayout>
@@ -25,21 +27,13 @@
 
 // 静态辅助函数：解析日期时间字符串，支持多种格式
 static QDateTime parseDateTime(const QString& dateTimeStr) {
-    QDateTime dt = QDateTime::fromString(dateTimeStr, "yyyy-MM-dd HH:mm:ss");
-    if (!dt.isValid()) {
-        dt = QDateTime::fromString(dateTimeStr, "yyyy-MM-dd HH:mm");
+    // yyyy-MM-dd [HH:mm[:ss]] 由固定格式解析器处理，其余格式（带时区、毫秒等）按 ISO 8601 解析
+    bool ok = false;
+    qint64 secs = TimestampParser::parse(dateTimeStr, &ok);
+    if (ok) {
+        return TimestampParser::toDateTime(secs);
     }
-    if (!dt.isValid()) {
-        dt = QDateTime::fromString(dateTimeStr, Qt::ISODate);
-    }
-    if (!dt.isValid()) {
-        // 如果还是无效，尝试只解析日期
-        QDate date = QDate::fromString(dateTimeStr, "yyyy-MM-dd");
-        if (date.isValid()) {
-            dt = QDateTime(date, QTime(0, 0));
-        }
-    }
-    return dt;
+    return QDateTime::fromString(dateTimeStr, Qt::ISODate);
 }
 
 
@@ -131,41 +125,6 @@ AccountBookRecordWidget::AccountBookRecordWidget(QWidget *parent)
     });
 }
 
-QMap<QString, QString> getCateNameMap() {
-    QMap<QString, QString> cateMap;
-    // 一一对应：中文分类名 → 拼音文件名（无后缀）
-    cateMap["餐饮"] = "canyin";
-    cateMap["服饰"] = "fushi";
-    cateMap["日用"] = "riyong";
-    cateMap["数码"] = "shuma";
-    cateMap["美妆"] = "meizhuang";
-    cateMap["软件"] = "ruanjian";
-    cateMap["住房"] = "zhufang";
-    cateMap["交通"] = "jiaotong";
-    cateMap["娱乐"] = "yule";
-    cateMap["医疗"] = "yiliao";
-    cateMap["通讯"] = "tongxun";
-    cateMap["汽车"] = "qiche";
-    cateMap["学习"] = "xuexi";
-    cateMap["办公"] = "bangong";
-    cateMap["运动"] = "yundong";
-    cateMap["社交"] = "shejiao";
-    cateMap["宠物"] = "chongwu";
-    cateMap["旅行"] = "lvxing";
-    cateMap["育儿"] = "yuer";
-    cateMap["其他"] = "qita";
-
-    cateMap["副业"] = "fuye";
-    cateMap["工资"] = "gongzi";
-    cateMap["红包"] = "hongbao";
-    cateMap["兼职"] = "jianzhi";
-    cateMap["其他"] = "qita";
-    cateMap["投资"] = "touzi";
-    cateMap["意外收入"] = "yiwaishouru";
-    return cateMap;
-}
-
-
 QWidget* AccountBookRecordWidget::createCateBtn(const QString& text, const QString& imgDir)
 {
     QWidget *container = new QWidget();
@@ -179,10 +138,11 @@ QWidget* AccountBookRecordWidget::createCateBtn(const QString& text, const QStri
     btn->setFixedSize(50, 50);
     btn->setObjectName("cateButton");
     
-    // ===== 核心修改：通过映射表获取拼音文件名 =====
-    QMap<QString, QString> cateMap = getCateNameMap();
+    // ===== 核心修改：通过分类注册表获取拼音文件名 =====
+    CategoryRegistry* registry = CategoryRegistry::getInstance();
     // 取拼音名，若没找到则默认用"qita（其他）"
-    QString pinyinName = cateMap.value(text, "qita");
+    QString pinyinName = registry->icon(registry->intern(text));
+    if (pinyinName.isEmpty()) pinyinName = "qita";
     // 拼接路径（用拼音名替代原来的中文）
     // 注意：qrc 路径为 :/<prefix>/<file_path_in_qrc>
     // 在 res.qrc 中，前缀是 /classify1 或 /classify2，文件路径是 resources/classifyX/xxx.jpg
@@ -651,7 +611,7 @@ void AccountBookRecordWidget::createKeyboard()
 
         // 7. 预算检查（仅对支出进行检查）
         if (amount < 0) {
-            QString budgetWarning = BudgetManager::getInstance()->checkBudgetExceeded(userId, amount, m_currentDateTime);
+            QString budgetWarning = BudgetManager::getInstance()->checkBudgetExceeded(userId, amount, m_currentDateTime, category);
             if (!budgetWarning.isEmpty()) {
                 QMessageBox::StandardButton reply = QMessageBox::warning(this, "预算超额提醒", 
                     budgetWarning + "\n\n是否继续记账？", 
@@ -8,7 +8,39 @@
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QVariantList>
+#include <QSet>
 #include "sqlite_helper.h"
+#include "category_registry.h"
+
+namespace {
+// bill 表批量插入的列顺序
+const QStringList kBillColumns = {
+    "user_id", "book_id", "category_id", "bill_date", "amount", "type",
+    "description", "voucher_path", "is_deleted", "delete_time",
+    "create_time", "update_time", "local_id"
+};
+
+// 一次同步的账单数达到此值时按批量导入配置档写入
+const int kBulkImportThreshold = 1000;
+
+// 编辑单条记录（单条编辑与批量编辑共用，语句缓存中只保留一份）
+const char* const kEditRecordSql = R"(
+        UPDATE account_record 
+        SET amount = ?, type = ?, bill_date = ?, category = ?, remark = ?, description = ?, create_time = ?, modify_time = ?
+        WHERE id = ? AND user_id = ?
+    )";
+
+QVariantList editRecordParams(int userId, int recordId, const QJsonObject& recordObj, const QString& modifyTime)
+{
+    QString billDate = recordObj["billDate"].toString();
+    QString description = recordObj["description"].toString();
+    QVariantList params;
+    params << recordObj["amount"].toDouble() << recordObj["type"].toInt() << billDate
+           << recordObj["category"].toString() << description << description << billDate
+           << modifyTime << recordId << userId;
+    return params;
+}
+}
 
 bill_handler::bill_handler()
     : m_dbHelper(SqliteHelper::getInstance())
@@ -49,6 +81,9 @@ QJsonObject bill_handler::handleSyncBills(const QJsonObject& request)
     // 获取账本ID（可选，默认为1）
     int bookId = request.contains("bookId") ? request["bookId"].toInt() : 1;
     
+    // 大批量同步时按批量导入配置档写入，处理完毕后切回原配置档
+    SqliteHelper::ScopedDurabilityProfile bulkProfile(
+        m_dbHelper, billsArray.size() >= kBulkImportThreshold ? QString("bulk-import") : QString());
     // 开启事务处理批量同步
     if (!m_dbHelper->beginTransaction()) {
         QString error = m_dbHelper->getLastError();
@@ -61,6 +96,13 @@ QJsonObject bill_handler::handleSyncBills(const QJsonObject& request)
     int successCount = 0;
     int failCount = 0;
     QList<AccountRecord> recordsToSync;
+    // 待插入的账单按列收集，最后一次性批量写入
+    QList<QVariantList> billColumns;
+    for (int i = 0; i < kBillColumns.size(); ++i) {
+        billColumns << QVariantList();
+    }
+    QSet<int> stagedLocalIds;
+    StagedCategoryIds stagedCategoryIds;
     QJsonArray billsResponseArray;  // 用于返回 localId 和 serverId 映射
     
     // 解析账单数据并直接插入到 SQLite bill 表
@@ -78,22 +120,43 @@ QJsonObject bill_handler::handleSyncBills(const QJsonObject& request)
             userId = record.getUserId();
         }
         
-        // 直接插入到 SQLite bill 表
-        if (insertBillToDatabase(record, bookId)) {
+        // 校验并整理为待插入的一行
+        if (stageBillRow(record, bookId, billColumns, stagedLocalIds, stagedCategoryIds)) {
             successCount++;
         } else {
             failCount++;
         }
     }
+
+    // 批量插入 SQLite bill 表（并入上面开启的事务）
+    if (successCount > 0) {
+        SqliteHelper::BulkWriteResult written = m_dbHelper->bulkInsert("bill", kBillColumns, billColumns);
+        if (!written.success) {
+            qWarning() << "【handleSyncBills】批量插入失败：" << m_dbHelper->getLastError();
+            failCount += successCount;
+            successCount = 0;
+        }
+    }
     
     // 提交或回滚事务
+    if (successCount > 0 && !m_dbHelper->commitTransaction()) {
+        qWarning() << "【handleSyncBills】提交事务失败：" << m_dbHelper->getLastError();
+        failCount += successCount;
+        successCount = 0;
+    }
     if (successCount > 0) {
-        m_dbHelper->commitTransaction();
+        // 事务已提交，本批查到（含自动创建）的分类 ID 才写入注册表缓存
+        CategoryRegistry* registry = CategoryRegistry::getInstance();
+        for (auto it = stagedCategoryIds.constBegin(); it != stagedCategoryIds.constEnd(); ++it) {
+            registry->setBillCategoryId(it.key().first, it.key().second, it.value());
+        }
         response["success"] = true;
         response["message"] = QString("同步成功：%1条记录，失败：%2条").arg(successCount).arg(failCount);
         response["successCount"] = successCount;
         response["failCount"] = failCount;
         qDebug() << "【handleSyncBills】同步完成：" << response["message"].toString();
+        SqliteHelper::StatementCacheStats cacheStats = m_dbHelper->getStatementCacheStats();
+        qDebug() << "【handleSyncBills】语句缓存命中：" << cacheStats.hits << "，未命中：" << cacheStats.misses;
     } else {
         m_dbHelper->rollbackTransaction();
         response["success"] = false;
@@ -139,8 +202,10 @@ QJsonObject bill_handler::handleAddRecord(const QJsonObject& request)
     QVariantList checkParams;
     checkParams << userId << billDate << amount << category;
     
-    QSqlQuery query = m_dbHelper->executeQueryWithParams(checkSql, checkParams);
-    if (query.next()) {
+    SqliteHelper::CachedQuery query = m_dbHelper->executeQueryWithParams(checkSql, checkParams);
+    bool exists = query.next();
+    query.finish();  // 释放缓存语句，便于下次复用
+    if (exists) {
         response["success"] = true;
         response["message"] = "记录已存在（同步忽略）";
         qDebug() << "【handleAddRecord】记录已存在，跳过重复插入：" << category << amount;
@@ -194,24 +259,10 @@ QJsonObject bill_handler::handleEditRecord(const QJsonObject& request)
     int recordId = request["recordId"].toInt();
     QJsonObject recordObj = request["record"].toObject();
 
-    double amount = recordObj["amount"].toDouble();
-    int type = recordObj["type"].toInt();
-    QString billDate = recordObj["billDate"].toString();
-    QString category = recordObj["category"].toString();
-    QString description = recordObj["description"].toString();
-
-    QString sql = R"(
-        UPDATE account_record 
-        SET amount = ?, type = ?, bill_date = ?, category = ?, remark = ?, description = ?, create_time = ?, modify_time = ?
-        WHERE id = ? AND user_id = ?
-    )";
-
-    QVariantList params;
-    params << amount << type << billDate << category << description << description << billDate
-           << QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")
-           << recordId << userId;
+    QVariantList params = editRecordParams(userId, recordId, recordObj,
+                                           QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"));
 
-    if (m_dbHelper->executeSqlWithParams(sql, params)) {
+    if (m_dbHelper->executeSqlWithParams(kEditRecordSql, params)) {
         response["success"] = true;
         response["message"] = "记录更新成功";
     } else {
@@ -222,6 +273,61 @@ QJsonObject bill_handler::handleEditRecord(const QJsonObject& request)
     return response;
 }
 
+QJsonObject bill_handler::handleBatchEditRecords(const QJsonObject& request)
+{
+    QJsonObject response;
+    response["type"] = "batch_edit_records_response";
+
+    if (!request.contains("userId") || !request.contains("records")) {
+        response["success"] = false;
+        response["message"] = "请求参数不完整";
+        return response;
+    }
+
+    int userId = request["userId"].toInt();
+    QJsonArray records = request["records"].toArray();
+    if (userId <= 0 || records.isEmpty()) {
+        response["success"] = false;
+        response["message"] = "用户ID无效或记录列表为空";
+        return response;
+    }
+
+    // 整批在一个事务中应用，任一条失败则全部回滚
+    if (!m_dbHelper->beginTransaction()) {
+        response["success"] = false;
+        response["message"] = "开启事务失败：" + m_dbHelper->getLastError();
+        return response;
+    }
+
+    QString modifyTime = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
+    bool ok = true;
+    for (const QJsonValue& value : records) {
+        QJsonObject item = value.toObject();
+        QVariantList params = editRecordParams(userId, item["recordId"].toInt(),
+                                               item["record"].toObject(), modifyTime);
+        if (!m_dbHelper->executeSqlWithParams(kEditRecordSql, params)) {
+            ok = false;
+            break;
+        }
+    }
+    if (ok) ok = m_dbHelper->commitTransaction();
+
+    if (ok) {
+        response["success"] = true;
+        response["message"] = QString("批量更新成功，共 %1 条").arg(records.size());
+        response["updatedCount"] = records.size();
+        qDebug() << "【handleBatchEditRecords】用户" << userId << "批量更新" << records.size() << "条记录";
+    } else {
+        QString error = m_dbHelper->getLastError();
+        m_dbHelper->rollbackTransaction();
+        response["success"] = false;
+        response["message"] = "批量更新失败：" + error;
+        qWarning() << "【handleBatchEditRecords】批量更新失败：" << error;
+    }
+
+    return response;
+}
+
 QJsonObject bill_handler::handleDeleteRecord(const QJsonObject& request)
 {
     QJsonObject response;
@@ -571,13 +677,27 @@ QJsonArray bill_handler::recordsToJsonArray(const QList<AccountRecord>& records)
  * @brief 查询分类ID
  * @param categoryName 分类名称（如"餐饮"、"交通"）
  * @param userId 用户ID
+ * @param stagedCategoryIds 查到的 ID 先暂存于此，事务提交后才写入分类注册表
  * @return 分类ID，查不到返回 -1
  */
-int bill_handler::queryCategoryId(const QString& categoryName, int userId)
+int bill_handler::queryCategoryId(const QString& categoryName, int userId, StagedCategoryIds& stagedCategoryIds)
 {
     if (categoryName.isEmpty() || userId <= 0) {
         return -1;
     }
+
+    // 同一用户同一分类的 ID 只查一次，之后直接取注册表中的缓存或本批暂存的结果
+    CategoryRegistry* registry = CategoryRegistry::getInstance();
+    int registryId = registry->intern(categoryName);
+    int cachedId = registry->billCategoryId(userId, registryId);
+    if (cachedId > 0) {
+        return cachedId;
+    }
+    QPair<int, int> key(userId, registryId);
+    auto staged = stagedCategoryIds.constFind(key);
+    if (staged != stagedCategoryIds.constEnd()) {
+        return staged.value();
+    }
     
     QString sql = R"(
         SELECT id FROM bill_category 
@@ -588,9 +708,12 @@ int bill_handler::queryCategoryId(const QString& categoryName, int userId)
     QVariantList params;
     params << userId << categoryName;
     
-    QSqlQuery query = m_dbHelper->executeQueryWithParams(sql, params);
+    SqliteHelper::CachedQuery query = m_dbHelper->executeQueryWithParams(sql, params);
     if (query.next()) {
-        return query.value(0).toInt();
+        int categoryId = query.value(0).toInt();
+        query.finish();  // 释放缓存语句，便于下次复用
+        stagedCategoryIds.insert(key, categoryId);
+        return categoryId;
     }
     
     qWarning() << "【queryCategoryId】未找到分类：" << categoryName << "，用户ID：" << userId;
@@ -598,23 +721,28 @@ int bill_handler::queryCategoryId(const QString& categoryName, int userId)
 }
 
 /**
- * @brief 将 AccountRecord 直接插入到 MySQL bill 表
+ * @brief 校验 AccountRecord 并整理为 bill 表的一行，追加到按列收集的批量数据中
  * @param record 账单记录
  * @param defaultBookId 默认账本ID（当无法确定时使用）
- * @return 是否插入成功
+ * @param billColumns 按 kBillColumns 顺序收集的列数据
+ * @param stagedLocalIds 本批已收集的 local_id，用于批内去重
+ * @param stagedCategoryIds 本批查到的分类 ID，事务提交后由调用方写入分类注册表
+ * @return 是否处理成功（已存在的记录视为成功，不重复收集）
  */
-bool bill_handler::insertBillToDatabase(const AccountRecord& record, int defaultBookId)
+bool bill_handler::stageBillRow(const AccountRecord& record, int defaultBookId,
+                                QList<QVariantList>& billColumns, QSet<int>& stagedLocalIds,
+                                StagedCategoryIds& stagedCategoryIds)
 {
     if (record.getUserId() <= 0 || record.getAmount() == 0) {
-        qWarning() << "【insertBillToDatabase】无效的记录：userId=" << record.getUserId() 
+        qWarning() << "【stageBillRow】无效的记录：userId=" << record.getUserId() 
                   << "，amount=" << record.getAmount();
         return false;
     }
     
     // 1. 查询分类ID
-    int categoryId = queryCategoryId(record.getType(), record.getUserId());
+    int categoryId = queryCategoryId(record.getType(), record.getUserId(), stagedCategoryIds);
     if (categoryId <= 0) {
-        qDebug() << "【insertBillToDatabase】分类不存在，尝试自动创建：" << record.getType();
+        qDebug() << "【stageBillRow】分类不存在，尝试自动创建：" << record.getType();
         // 自动创建分类
         QString insertCatSql = R"(
             INSERT INTO bill_category (user_id, name, type, create_time) 
@@ -627,11 +755,11 @@ bool bill_handler::insertBillToDatabase(const AccountRecord& record, int default
                   << QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
         
         if (m_dbHelper->executeSqlWithParams(insertCatSql, catParams)) {
-            categoryId = queryCategoryId(record.getType(), record.getUserId());
+            categoryId = queryCategoryId(record.getType(), record.getUserId(), stagedCategoryIds);
         }
         
         if (categoryId <= 0) {
-            qWarning() << "【insertBillToDatabase】自动创建分类失败，使用默认分类ID=1";
+            qWarning() << "【stageBillRow】自动创建分类失败，使用默认分类ID=1";
             categoryId = 1;
         }
     }
@@ -642,12 +770,18 @@ bool bill_handler::insertBillToDatabase(const AccountRecord& record, int default
     // 1.2 在这种客户端服务端共用数据库的演示模式下，先检查是否已存在记录
     // 优先检查 local_id (如果记录是从本地同步上来的)
     if (record.getId() > 0) {
+        if (stagedLocalIds.contains(record.getId())) {
+            qDebug() << "【stageBillRow】本批已包含该记录(local_id=" << record.getId() << ")，跳过";
+            return true;
+        }
         QString checkIdSql = "SELECT id FROM bill WHERE user_id = ? AND local_id = ?";
         QVariantList checkIdParams;
         checkIdParams << record.getUserId() << record.getId();
-        QSqlQuery idQuery = m_dbHelper->executeQueryWithParams(checkIdSql, checkIdParams);
-        if (idQuery.next()) {
-            qDebug() << "【insertBillToDatabase】记录已存在(local_id=" << record.getId() << ")，跳过插入";
+        SqliteHelper::CachedQuery idQuery = m_dbHelper->executeQueryWithParams(checkIdSql, checkIdParams);
+        bool exists = idQuery.next();
+        idQuery.finish();  // 释放缓存语句，便于下次复用
+        if (exists) {
+            qDebug() << "【stageBillRow】记录已存在(local_id=" << record.getId() << ")，跳过插入";
             return true;
         }
     }
@@ -656,48 +790,38 @@ bool bill_handler::insertBillToDatabase(const AccountRecord& record, int default
     // 根据金额正负判断：正数为收入(1)，负数为支出(0)
     int type = (record.getAmount() >= 0) ? 1 : 0;
     
-    // 3. 构造 SQL 插入语句
-    QString sql = R"(
-        INSERT INTO bill (
-            user_id, book_id, category_id, bill_date, amount, type, 
-            description, voucher_path, is_deleted, delete_time, 
-            create_time, update_time, local_id
-        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-    )";
-    
-    QVariantList params;
-    params << record.getUserId()           // user_id
-           << defaultBookId                 // book_id
-           << categoryId                    // category_id
-           << record.getCreateTime()        // bill_date
-           << record.getAmount()            // amount
-           << type                          // type（0=支出，1=收入）
-           << record.getRemark()            // description
-           << record.getVoucherPath()       // voucher_path
-           << record.getIsDeleted()         // is_deleted
-           << record.getDeleteTime()        // delete_time
-           << record.getCreateTime()        // create_time
-           << record.getModifyTime()        // update_time
-           << record.getId();               // local_id（保存本地ID用于后续同步）
-    
-    bool success = m_dbHelper->executeSqlWithParams(sql, params);
-    
-    if (success) {
-        qDebug() << "【insertBillToDatabase】成功插入账单：userId=" << record.getUserId() 
-                << "，amount=" << record.getAmount() << "，category=" << record.getType();
-    } else {
-        qWarning() << "【insertBillToDatabase】插入失败：" << m_dbHelper->getLastError();
+    // 3. 按列追加（顺序与 kBillColumns 一致）
+    QVariantList row;
+    row << record.getUserId()           // user_id
+        << defaultBookId                 // book_id
+        << categoryId                    // category_id
+        << record.getCreateTime()        // bill_date
+        << record.getAmount()            // amount
+        << type                          // type（0=支出，1=收入）
+        << record.getRemark()            // description
+        << record.getVoucherPath()       // voucher_path
+        << record.getIsDeleted()         // is_deleted
+        << record.getDeleteTime()        // delete_time
+        << record.getCreateTime()        // create_time
+        << record.getModifyTime()        // update_time
+        << record.getId();               // local_id（保存本地ID用于后续同步）
+    for (int i = 0; i < row.size(); ++i) {
+        billColumns[i] << row.at(i);
     }
-    
-    return success;
+    if (record.getId() > 0) {
+        stagedLocalIds.insert(record.getId());
+    }
+    return true;
 }
 
 void bill_handler::ensureUserAndBookExist(int userId, int bookId)
 {
     // 1. 确保用户存在
-    QString checkUser = QString("SELECT COUNT(*) FROM user WHERE id = %1").arg(userId);
-    QSqlQuery userQuery = m_dbHelper->executeQuery(checkUser);
-    if (userQuery.next() && userQuery.value(0).toInt() == 0) {
+    // 使用参数化查询，同步大批账单时可复用同一条预编译语句
+    SqliteHelper::CachedQuery userQuery = m_dbHelper->executeQueryWithParams("SELECT COUNT(*) FROM user WHERE id = ?", QVariantList() << userId);
+    bool userMissing = userQuery.next() && userQuery.value(0).toInt() == 0;
+    userQuery.finish();
+    if (userMissing) {
         qDebug() << "【ensureUserAndBookExist】用户不存在，尝试自动补全：" << userId;
         QString insertUser = R"(
             INSERT INTO user (id, account, password, nickname, create_time) 
@@ -709,9 +833,10 @@ void bill_handler::ensureUserAndBookExist(int userId, int bookId)
     }
 
     // 2. 确保账本存在
-    QString checkBook = QString("SELECT COUNT(*) FROM account_book WHERE id = %1").arg(bookId);
-    QSqlQuery bookQuery = m_dbHelper->executeQuery(checkBook);
-    if (bookQuery.next() && bookQuery.value(0).toInt() == 0) {
+    SqliteHelper::CachedQuery bookQuery = m_dbHelper->executeQueryWithParams("SELECT COUNT(*) FROM account_book WHERE id = ?", QVariantList() << bookId);
+    bool bookMissing = bookQuery.next() && bookQuery.value(0).toInt() == 0;
+    bookQuery.finish();
+    if (bookMissing) {
         qDebug() << "【ensureUserAndBookExist】账本不存在，尝试自动补全：" << bookId;
         QString insertBook = R"(
             INSERT INTO account_book (id, user_id, name, create_time) 
@@ -722,3 +847,22 @@ void bill_handler::ensureUserAndBookExist(int userId, int bookId)
         m_dbHelper->executeSqlWithParams(insertBook, bookParams);
     }
 }
+
+QJsonObject bill_handler::handleServerStatus(const QJsonObject& request)
+{
+    Q_UNUSED(request);
+    QJsonObject response;
+    response["type"] = "server_status_response";
+
+    if (!m_dbHelper->getDatabase().isOpen()) {
+        response["success"] = false;
+        response["message"] = "数据库未打开";
+        return response;
+    }
+
+    // 无写入时直接返回缓存结果，不会重复扫描数据表
+    SqliteHelper::DatabaseStatistics stats = m_dbHelper->getDatabaseStatistics();
+    response["success"] = true;
+    response["statistics"] = stats.toJson();
+    return response;
+}
@@ -5,6 +5,10 @@
 #include <QJsonArray>
 #include <QString>
 #include <QList>
+#include <QSet>
+#include <QHash>
+#include <QPair>
+#include <QVariantList>
 #include "account_record.h"
 #include "account_manager.h"
 
@@ -25,6 +29,9 @@ public:
     // 处理编辑记账记录请求
     QJsonObject handleEditRecord(const QJsonObject& request);
 
+    // 处理批量编辑记账记录请求（一个事务内完成）
+    QJsonObject handleBatchEditRecords(const QJsonObject& request);
+
     // 处理删除记账记录请求（软删除）
     QJsonObject handleDeleteRecord(const QJsonObject& request);
 
@@ -40,16 +47,25 @@ public:
     // 处理备份数据请求
     QJsonObject handleBackupData(const QJsonObject& request);
 
+    // 处理服务器状态查询（数据库统计信息，结果带缓存，可频繁轮询）
+    QJsonObject handleServerStatus(const QJsonObject& request);
+
 private:
     SqliteHelper* m_dbHelper;
     AccountManager* m_accountManager;
     
-    // 直接操作 MySQL bill 表
-    bool insertBillToDatabase(const AccountRecord& record, int defaultBookId = 1);
+    // 同步事务中查到的 bill_category.id：(用户ID, 分类编号) → id。分类可能是本事务自动创建的，
+    // 事务提交后才写入分类注册表，回滚时随之丢弃
+    using StagedCategoryIds = QHash<QPair<int, int>, int>;
+
+    // 校验账单并按列收集到批量插入数据中（bill 表）
+    bool stageBillRow(const AccountRecord& record, int defaultBookId,
+                      QList<QVariantList>& billColumns, QSet<int>& stagedLocalIds,
+                      StagedCategoryIds& stagedCategoryIds);
 
     // 确保用户和账本存在（处理外键约束）
     void ensureUserAndBookExist(int userId, int bookId);
-    int queryCategoryId(const QString& categoryName, int userId);
+    int queryCategoryId(const QString& categoryName, int userId, StagedCategoryIds& stagedCategoryIds);
     
     // 将 AccountRecord 转换为 JSON 对象
     QJsonObject recordToJson(const AccountRecord& record);
@@ -1,4 +1,6 @@
 #include "budget_manager.h"
+#include "category_registry.h"
+#include "timestamp_parser.h"
 #include <QSqlQuery>
 #include <QDateTime>
 #include <QDebug>
@@ -22,91 +24,248 @@ BudgetManager* BudgetManager::getInstance() {
 }
 
 bool BudgetManager::setBudget(int userId, double daily, double monthly, double yearly) {
-    QString sql = QString(R"(
-        INSERT INTO budget (user_id, daily_budget, monthly_budget, yearly_budget)
-        VALUES (%1, %2, %3, %4)
-        ON CONFLICT(user_id) DO UPDATE SET
-        daily_budget = excluded.daily_budget,
-        monthly_budget = excluded.monthly_budget,
-        yearly_budget = excluded.yearly_budget
-    )").arg(userId).arg(daily).arg(monthly).arg(yearly);
-    
-    return m_dbHelper->executeSql(sql);
+    const QList<QPair<BudgetPeriod, double>> limits = {
+        {BudgetPeriod::Daily, daily}, {BudgetPeriod::Monthly, monthly}, {BudgetPeriod::Yearly, yearly}
+    };
+    // 正数限额一次批量写入（已有规则更新限额），其余周期删除对应规则
+    static const QStringList columns = {"user_id", "category", "period", "limit_amount"};
+    QList<QVariantList> values = {QVariantList(), QVariantList(), QVariantList(), QVariantList()};
+    for (const auto& limit : limits) {
+        if (limit.second <= 0) continue;
+        values[0] << userId;
+        values[1] << QString("");
+        values[2] << int(limit.first);
+        values[3] << limit.second;
+    }
+
+    if (!m_dbHelper->beginTransaction()) return false;
+    bool ok = m_dbHelper->bulkUpsert("budget_rule", columns, values,
+                                     {"user_id", "category", "period"}).success;
+    for (const auto& limit : limits) {
+        if (ok && limit.second <= 0) ok = setBudgetRule(userId, QString(), limit.first, 0);
+    }
+    if (ok) ok = m_dbHelper->commitTransaction();
+    if (!ok) m_dbHelper->rollbackTransaction();
+    QMutexLocker locker(&m_dataMutex);
+    m_rules.remove(userId);
+    return ok;
 }
 
 BudgetInfo BudgetManager::getBudget(int userId) {
     BudgetInfo info;
-    QString sql = QString("SELECT daily_budget, monthly_budget, yearly_budget FROM budget WHERE user_id = %1").arg(userId);
-    QSqlQuery query = m_dbHelper->executeQuery(sql);
-    if (query.next()) {
-        info.daily = query.value(0).toDouble();
-        info.monthly = query.value(1).toDouble();
-        info.yearly = query.value(2).toDouble();
+    QMutexLocker locker(&m_dataMutex);
+    for (const BudgetRule& rule : rulesLocked(userId)) {
+        if (!rule.category.isEmpty()) continue;
+        switch (rule.period) {
+        case BudgetPeriod::Daily: info.daily = rule.limit; break;
+        case BudgetPeriod::Monthly: info.monthly = rule.limit; break;
+        case BudgetPeriod::Yearly: info.yearly = rule.limit; break;
+        }
     }
     return info;
 }
 
-QString BudgetManager::checkBudgetExceeded(int userId, double newAmount, const QDateTime& checkDate) {
+// ============ 预算规则 ============
+bool BudgetManager::setBudgetRule(int userId, const QString& category, BudgetPeriod period, double limit) {
+    bool ok;
+    if (limit > 0) {
+        ok = m_dbHelper->executeSqlWithParams(R"(
+            INSERT INTO budget_rule (user_id, category, period, limit_amount)
+            VALUES (?, ?, ?, ?)
+            ON CONFLICT(user_id, category, period) DO UPDATE SET
+            limit_amount = excluded.limit_amount
+        )", {userId, category, int(period), limit});
+    } else {
+        ok = m_dbHelper->executeSqlWithParams(
+            "DELETE FROM budget_rule WHERE user_id = ? AND category = ? AND period = ?",
+            {userId, category, int(period)});
+    }
+    if (ok) {
+        QMutexLocker locker(&m_dataMutex);
+        m_rules.remove(userId);
+    }
+    return ok;
+}
+
+QList<BudgetRule> BudgetManager::getBudgetRules(int userId) {
+    QMutexLocker locker(&m_dataMutex);
+    return rulesLocked(userId);
+}
+
+QString BudgetManager::checkBudgetExceeded(int userId, double newAmount, const QDateTime& checkDate,
+                                           const QString& category) {
     if (newAmount >= 0) return ""; // 收入不触发预算检查
 
-    BudgetInfo budget = getBudget(userId);
-    if (budget.daily <= 0 && budget.monthly <= 0 && budget.yearly <= 0) return "";
+    qint64 current = m_dbHelper->recordGeneration();
+    QMutexLocker locker(&m_dataMutex);
+    syncGeneration(current, current);
 
     double absNewAmount = qAbs(newAmount);
+    QDate date = checkDate.date();
+    // 规则按全部支出在前、日月年的顺序排列，返回第一条超额的规则
+    for (const BudgetRule& rule : rulesLocked(userId)) {
+        if (!rule.category.isEmpty() && rule.category != category) continue;
+
+        qint64 spentCents = 0;
+        if (!spentCentsLocked(userId, rule.category, rule.period, date, spentCents)) continue;
+        double spent = spentCents / 100.0;
+        if (spent + absNewAmount <= rule.limit) continue;
 
-    // 1. 检查日预算
-    if (budget.daily > 0) {
-        QString dateStr = checkDate.toString("yyyy-MM-dd");
-        QString sql = QString(R"(
-            SELECT SUM(ABS(amount)) FROM account_record 
-            WHERE user_id = %1 AND amount < 0 AND is_deleted = 0 
-            AND create_time LIKE '%2%'
-        )").arg(userId).arg(dateStr);
-        QSqlQuery query = m_dbHelper->executeQuery(sql);
-        double currentDaily = 0;
-        if (query.next()) currentDaily = query.value(0).toDouble();
-        
-        if (currentDaily + absNewAmount > budget.daily) {
-            return QString("【%1】日预算超额！\n该日已支出: ¥%2\n当前记账: ¥%3\n日预算限额: ¥%4")
-                .arg(dateStr).arg(currentDaily, 0, 'f', 2).arg(absNewAmount, 0, 'f', 2).arg(budget.daily, 0, 'f', 2);
+        QString periodText;
+        QString periodName;
+        switch (rule.period) {
+        case BudgetPeriod::Daily: periodText = checkDate.toString("yyyy-MM-dd"); periodName = "日"; break;
+        case BudgetPeriod::Monthly: periodText = checkDate.toString("yyyy-MM"); periodName = "月"; break;
+        case BudgetPeriod::Yearly: periodText = checkDate.toString("yyyy"); periodName = "年"; break;
         }
+        QString scope = rule.category.isEmpty() ? QString() : "「" + rule.category + "」";
+        // 金额先填入，分类名最后一次性替换，其中的 % 不会被当作占位符
+        return QString("【%4】%5%6预算超额！\n该%6%5已支出: ¥%1\n当前记账: ¥%2\n%6预算限额: ¥%3")
+            .arg(spent, 0, 'f', 2).arg(absNewAmount, 0, 'f', 2).arg(rule.limit, 0, 'f', 2)
+            .arg(periodText, scope, periodName);
     }
+    return "";
+}
 
-    // 2. 检查月预算
-    if (budget.monthly > 0) {
-        QString monthStr = checkDate.toString("yyyy-MM");
-        QString sql = QString(R"(
-            SELECT SUM(ABS(amount)) FROM account_record 
-            WHERE user_id = %1 AND amount < 0 AND is_deleted = 0 
-            AND create_time LIKE '%2%'
-        )").arg(userId).arg(monthStr);
-        QSqlQuery query = m_dbHelper->executeQuery(sql);
-        double currentMonthly = 0;
-        if (query.next()) currentMonthly = query.value(0).toDouble();
-        
-        if (currentMonthly + absNewAmount > budget.monthly) {
-            return QString("【%1】月预算超额！\n该月已支出: ¥%2\n当前记账: ¥%3\n月预算限额: ¥%4")
-                .arg(monthStr).arg(currentMonthly, 0, 'f', 2).arg(absNewAmount, 0, 'f', 2).arg(budget.monthly, 0, 'f', 2);
-        }
+// ============ 写入后更新计数 ============
+void BudgetManager::applyRecordChanges(const QList<AccountRecord>& before, const QList<AccountRecord>& after,
+                                       qint64 generationBefore, qint64 generationAfter) {
+    QMutexLocker locker(&m_dataMutex);
+    if (m_generation != generationBefore) {
+        syncGeneration(generationBefore, generationAfter);
+        return;
     }
+    m_generation = generationAfter;
+    if (m_spent.isEmpty()) return;
 
-    // 3. 检查年预算
-    if (budget.yearly > 0) {
-        QString yearStr = checkDate.toString("yyyy");
-        QString sql = QString(R"(
-            SELECT SUM(ABS(amount)) FROM account_record 
-            WHERE user_id = %1 AND amount < 0 AND is_deleted = 0 
-            AND create_time LIKE '%2%'
-        )").arg(userId).arg(yearStr);
-        QSqlQuery query = m_dbHelper->executeQuery(sql);
-        double currentYearly = 0;
-        if (query.next()) currentYearly = query.value(0).toDouble();
-        
-        if (currentYearly + absNewAmount > budget.yearly) {
-            return QString("【%1】年预算超额！\n该年已支出: ¥%2\n当前记账: ¥%3\n年预算限额: ¥%4")
-                .arg(yearStr).arg(currentYearly, 0, 'f', 2).arg(absNewAmount, 0, 'f', 2).arg(budget.yearly, 0, 'f', 2);
+    for (const AccountRecord& record : before) {
+        adjustLocked(record, -1);
+    }
+    for (const AccountRecord& record : after) {
+        adjustLocked(record, 1);
+    }
+}
+
+void BudgetManager::clear() {
+    QMutexLocker locker(&m_dataMutex);
+    m_rules.clear();
+    m_spent.clear();
+}
+
+void BudgetManager::periodRange(BudgetPeriod period, const QDate& date, QDate& firstDay, QDate& lastDay) {
+    switch (period) {
+    case BudgetPeriod::Daily:
+        firstDay = date;
+        lastDay = date;
+        break;
+    case BudgetPeriod::Monthly:
+        firstDay = QDate(date.year(), date.month(), 1);
+        lastDay = firstDay.addMonths(1).addDays(-1);
+        break;
+    case BudgetPeriod::Yearly:
+        firstDay = QDate(date.year(), 1, 1);
+        lastDay = QDate(date.year(), 12, 31);
+        break;
+    }
+}
+
+// ============ 私有方法 ============
+const QList<BudgetRule>& BudgetManager::rulesLocked(int userId) {
+    auto it = m_rules.find(userId);
+    if (it != m_rules.end()) {
+        return it.value();
+    }
+
+    QList<BudgetRule> rules;
+    SqliteHelper::CachedQuery query = m_dbHelper->executeQueryWithParams(
+        "SELECT id, category, period, limit_amount FROM budget_rule "
+        "WHERE user_id = ? ORDER BY category, period", {userId});
+    while (query.next()) {
+        BudgetRule rule;
+        rule.id = query.value(0).toInt();
+        rule.category = query.value(1).toString();
+        rule.period = static_cast<BudgetPeriod>(query.value(2).toInt());
+        rule.limit = query.value(3).toDouble();
+        rules.append(rule);
+    }
+    query.finish();
+    return m_rules.insert(userId, rules).value();
+}
+
+bool BudgetManager::spentCentsLocked(int userId, const QString& category, BudgetPeriod period,
+                                     const QDate& date, qint64& cents) {
+    QDate firstDay;
+    QDate lastDay;
+    periodRange(period, date, firstDay, lastDay);
+    int categoryId = category.isEmpty() ? -1 : CategoryRegistry::getInstance()->intern(category);
+    quint64 key = counterKey(categoryId, period, firstDay);
+
+    QHash<quint64, qint64>& counters = m_spent[userId];
+    auto it = counters.constFind(key);
+    if (it != counters.constEnd()) {
+        cents = it.value();
+        return true;
+    }
+
+    // 首次检查该周期：沿 daily_rollup 主键按日期范围读取一次
+    QString sql = "SELECT COALESCE(SUM(-sum_cents), 0) FROM daily_rollup "
+                  "WHERE user_id = ? AND day >= ? AND day <= ? AND type = 0";
+    QVariantList params;
+    params << userId << firstDay.toString("yyyy-MM-dd") << lastDay.toString("yyyy-MM-dd");
+    if (!category.isEmpty()) {
+        sql += " AND category = ?";
+        params << category;
+    }
+    SqliteHelper::CachedQuery query = m_dbHelper->executeQueryWithParams(sql, params);
+    bool found = query.next();
+    if (found) {
+        cents = query.value(0).toLongLong();
+    }
+    // 语句来自缓存，两条路径都要结束，否则一直占着读快照
+    query.finish();
+    if (!found) {
+        return false;
+    }
+    counters.insert(key, cents);
+    return true;
+}
+
+void BudgetManager::adjustLocked(const AccountRecord& record, int sign) {
+    if (record.getIsDeleted() != 0 || record.getAmount() >= 0) return;
+    auto user = m_spent.find(record.getUserId());
+    if (user == m_spent.end()) return;
+    bool ok = false;
+    qint64 secs = record.getBillTimestamp(&ok);
+    if (!ok) return;
+
+    // 与 daily_rollup 相同：金额逐条四舍五入到分
+    qint64 cents = -qRound64(record.getAmount() * 100);
+    qint64 julianDay = TimestampParser::toDate(secs).toJulianDay();
+    quint64 categoryKey = quint64(CategoryRegistry::getInstance()->idOf(record.getType()) + 1);
+    QHash<quint64, qint64>& counters = user.value();
+    for (auto it = counters.begin(); it != counters.end(); ++it) {
+        quint64 key = it.key();
+        quint64 keyCategory = key >> 34;
+        if (keyCategory != 0 && keyCategory != categoryKey) continue;
+
+        QDate firstDay = QDate::fromJulianDay(qint64(quint32(key)));
+        QDate first;
+        QDate last;
+        periodRange(static_cast<BudgetPeriod>((key >> 32) & 0x3), firstDay, first, last);
+        if (julianDay >= first.toJulianDay() && julianDay <= last.toJulianDay()) {
+            it.value() += sign * cents;
         }
     }
+}
 
-    return "";
+void BudgetManager::syncGeneration(qint64 expected, qint64 current) {
+    if (m_generation != expected && !m_spent.isEmpty()) {
+        qDebug() << "账单数据已被其他路径修改，清空预算计数";
+        m_spent.clear();
+    }
+    m_generation = current;
+}
+
+quint64 BudgetManager::counterKey(int categoryId, BudgetPeriod period, const QDate& firstDay) {
+    return (quint64(categoryId + 1) << 34) | (quint64(period) << 32) | quint32(firstDay.toJulianDay());
 }
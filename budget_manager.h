@@ -3,7 +3,11 @@
 
 #include <QObject>
 #include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QDate>
 #include "sqlite_helper.h"
+#include "account_record.h"
 
 struct BudgetInfo {
     double daily = 0;
@@ -11,27 +15,82 @@ struct BudgetInfo {
     double yearly = 0;
 };
 
+// 预算周期
+enum class BudgetPeriod {
+    Daily = 0,
+    Monthly = 1,
+    Yearly = 2
+};
+
+// 一条预算规则：一个周期内某分类（空串表示全部支出）的支出上限
+struct BudgetRule {
+    int id = 0;
+    QString category;
+    BudgetPeriod period = BudgetPeriod::Monthly;
+    double limit = 0;           // 限额（元，正数）
+};
+
+/**
+ * @brief 预算管理 - 每个用户可以有多条预算规则（全部支出或单个分类，按日、月、年）。
+ *        规则与已支出计数都保存在内存中：计数按 (分类, 周期, 首日) 首次检查时从 daily_rollup 读取，
+ *        之后由 AccountManager 每次写入按写入前后的记录增减，预算检查只是几次哈希查找与比较。
+ *        其他路径的写入通过 SqliteHelper 的账单写入计数发现，发现后清空计数重新读取。
+ */
 class BudgetManager : public QObject {
     Q_OBJECT
 public:
     static BudgetManager* getInstance();
-    
-    // 设置预算
+
+    // 设置预算（全部支出的日、月、年预算，0 表示不限）
     bool setBudget(int userId, double daily, double monthly, double yearly);
     // 获取预算
     BudgetInfo getBudget(int userId);
-    
+
+    // ============ 预算规则 ============
+    // 设置一条规则，同一 (分类, 周期) 只保留一条；limit <= 0 时删除
+    bool setBudgetRule(int userId, const QString& category, BudgetPeriod period, double limit);
+    // 用户的全部规则，全部支出的规则在前
+    QList<BudgetRule> getBudgetRules(int userId);
+
     // 检查预算是否超额
     // checkDate: 要检查的日期（如果不指定则默认为当前日期）
+    // category: 本次记账的分类，同时检查该分类的预算
     // 返回超额的类型描述，如果不超额则返回空字符串
-    QString checkBudgetExceeded(int userId, double currentAmount, const QDateTime& checkDate = QDateTime::currentDateTime());
+    QString checkBudgetExceeded(int userId, double currentAmount, const QDateTime& checkDate = QDateTime::currentDateTime(),
+                                const QString& category = QString());
+
+    // AccountManager 写入成功后调用：扣除写入前的记录，加上写入后的记录；
+    // generationBefore / generationAfter 为本线程写入前后的账单写入计数，计数停在写入前时才增减
+    void applyRecordChanges(const QList<AccountRecord>& before, const QList<AccountRecord>& after,
+                            qint64 generationBefore, qint64 generationAfter);
+    // 清空内存中的规则与计数（恢复备份等整体替换数据后调用）
+    void clear();
+
+    // 包含 date 的周期的首末日
+    static void periodRange(BudgetPeriod period, const QDate& date, QDate& firstDay, QDate& lastDay);
 
 private:
     BudgetManager();
     static BudgetManager* m_instance;
     static QMutex m_mutex;
-    
+
+    // 以下方法要求已持有 m_dataMutex
+    const QList<BudgetRule>& rulesLocked(int userId);
+    // 周期内的已支出（分，正数）；读取失败返回 false
+    bool spentCentsLocked(int userId, const QString& category, BudgetPeriod period,
+                          const QDate& date, qint64& cents);
+    void adjustLocked(const AccountRecord& record, int sign);
+    void syncGeneration(qint64 expected, qint64 current);
+
+    // 计数键：(分类编号 + 1) << 34 | 周期 << 32 | 首日儒略日，全部支出的分类编号为 -1
+    static quint64 counterKey(int categoryId, BudgetPeriod period, const QDate& firstDay);
+
     SqliteHelper* m_dbHelper;
+
+    QMutex m_dataMutex;
+    QHash<int, QList<BudgetRule>> m_rules;          // 已读取的用户规则
+    QHash<int, QHash<quint64, qint64>> m_spent;     // 用户 → 计数键 → 已支出（分）
+    qint64 m_generation = -1;                       // 计数对应的写入计数
 };
 
 #endif // BUDGET_MANAGER_H
@@ -1,4 +1,5 @@
 #include "business_logic.h"
+#include "timestamp_parser.h"
 #include <QRegularExpression>
 #include <QDateTime>
 
@@ -79,6 +80,49 @@ QMap<QString, double> BusinessLogic::calculateMonthlyCategorySummary(int year, i
     return summary;
 }
 
+double BusinessLogic::calculateIncome(AccountManager& manager, int userId, const RecordFilter& filter)
+{
+    // 按整天筛选时由区间合计索引直接给出，否则在数据库中聚合
+    double income = 0, expense = 0;
+    manager.getAmountSummary(userId, filter, income, expense);
+    return income;
+}
+
+double BusinessLogic::calculateExpense(AccountManager& manager, int userId, const RecordFilter& filter)
+{
+    // 与列表版本一致，支出以负数返回
+    double income = 0, expense = 0;
+    manager.getAmountSummary(userId, filter, income, expense);
+    return -expense;
+}
+
+double BusinessLogic::calculateBalance(AccountManager& manager, int userId, const RecordFilter& filter)
+{
+    double income = 0, expense = 0;
+    manager.getAmountSummary(userId, filter, income, expense);
+    return income - expense;
+}
+
+double BusinessLogic::calculateMonthlyBalance(AccountManager& manager, int userId, int year, int month)
+{
+    // 整月合计来自每日汇总表
+    double income = 0, expense = 0;
+    manager.getMonthlySummary(userId, year, month, income, expense);
+    return income - expense;
+}
+
+QMap<QString, double> BusinessLogic::calculateMonthlyCategorySummary(AccountManager& manager, int userId, int year, int month)
+{
+    // 每日汇总表中只有存在记录的分类，净额为 0 的分类也会保留
+    MonthlyTotals totals;
+    manager.queryMonthlyTotals(userId, year, month, totals);
+    QMap<QString, double> summary;
+    for (const CategoryTotal& total : totals.categories) {
+        summary[total.category] = RecordColumns::toYuan(total.incomeCents - total.expenseCents);
+    }
+    return summary;
+}
+
 bool BusinessLogic::isValidCategory(const QString& category, bool isExpense)
 {
     if(isExpense)
@@ -168,16 +212,13 @@ bool BusinessLogic::isSameMonth(const QString& dateString, int year, int month)
 
 QDate BusinessLogic::stringToDate(const QString& dateString)
 {
-    // 支持多种日期格式
-    QDateTime dt = QDateTime::fromString(dateString, "yyyy-MM-dd HH:mm:ss");
-    if(dt.isValid())
-        return dt.date();
-
-    dt = QDateTime::fromString(dateString, "yyyy-MM-dd");
-    if(dt.isValid())
-        return dt.date();
+    // yyyy-MM-dd [HH:mm[:ss]] 由固定格式解析器处理，不经过 QDateTime
+    bool ok = false;
+    qint64 secs = TimestampParser::parse(dateString, &ok);
+    if(ok)
+        return TimestampParser::toDate(secs);
 
-    dt = QDateTime::fromString(dateString, "MM/dd HH:mm");
+    QDateTime dt = QDateTime::fromString(dateString, "MM/dd HH:mm");
     if(dt.isValid())
         return dt.date();
 
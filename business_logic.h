@@ -5,6 +5,7 @@
 #include <QList>
 #include <QDate>
 #include "account_record.h"
+#include "account_manager.h"
 #include "User.h"
 
 class BusinessLogic : public QObject
@@ -22,6 +23,14 @@ public:
     double calculateMonthlyBalance(int year, int month, const QList<AccountRecord>& records);
     QMap<QString, double> calculateMonthlyCategorySummary(int year, int month, const QList<AccountRecord>& records);
 
+    // 按筛选条件统计：收支合计取自 AccountManager::getAmountSummary，整天范围由区间合计索引
+    // （RangeSumIndex，不可用时读每日汇总表 daily_rollup）得出，其他条件在 SQL 中聚合；整月统计直接读每日汇总表
+    double calculateIncome(AccountManager& manager, int userId, const RecordFilter& filter);
+    double calculateExpense(AccountManager& manager, int userId, const RecordFilter& filter);
+    double calculateBalance(AccountManager& manager, int userId, const RecordFilter& filter);
+    double calculateMonthlyBalance(AccountManager& manager, int userId, int year, int month);
+    QMap<QString, double> calculateMonthlyCategorySummary(AccountManager& manager, int userId, int year, int month);
+
     // 分类校验
     bool isValidCategory(const QString& category, bool isExpense);
     QStringList getValidCategories(bool isExpense);
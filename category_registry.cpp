@@ -0,0 +1,168 @@
+#include "category_registry.h"
+#include "sqlite_helper.h"
+#include <QSqlQuery>
+#include <QDebug>
+
+CategoryRegistry* CategoryRegistry::m_instance = nullptr;
+QMutex CategoryRegistry::m_instanceMutex;
+
+namespace {
+// 未配置颜色的分类在统计图表中使用的颜色
+const char* const kDefaultColor = "#CCCCCC";
+
+struct PresetCategory {
+    const char* name;
+    int type;
+    const char* icon;
+    const char* color;
+};
+
+// 预设分类：记账界面的分类按钮、统计图表颜色与 BusinessLogic/AccountManager 的预设列表
+const PresetCategory kPresets[] = {
+    // 支出
+    {"餐饮", 0, "canyin", "#FF6B6B"},   {"服饰", 0, "fushi", "#4ECDC4"},
+    {"日用", 0, "riyong", "#45B7D1"},   {"数码", 0, "shuma", "#96CEB4"},
+    {"美妆", 0, "meizhuang", "#FFEEAD"}, {"软件", 0, "ruanjian", "#D4A5A5"},
+    {"住房", 0, "zhufang", "#9A8C98"},  {"交通", 0, "jiaotong", "#C9ADA7"},
+    {"娱乐", 0, "yule", "#F2CC8F"},     {"医疗", 0, "yiliao", "#E07A5F"},
+    {"通讯", 0, "tongxun", "#3D405B"},  {"汽车", 0, "qiche", "#81B29A"},
+    {"学习", 0, "xuexi", "#F4F1DE"},    {"办公", 0, "bangong", "#A8DADC"},
+    {"运动", 0, "yundong", "#457B9D"},  {"社交", 0, "shejiao", "#1D3557"},
+    {"宠物", 0, "chongwu", "#E63946"},  {"旅行", 0, "lvxing", "#A2D2FF"},
+    {"育儿", 0, "yuer", "#BDE0FE"},     {"其他", 0, "qita", "#FFAFCC"},
+    {"美妆护肤", 0, "", ""}, {"应用软件", 0, "", ""}, {"购物", 0, "", ""},
+    {"居住", 0, "", ""}, {"教育", 0, "", ""}, {"人情", 0, "", ""},
+    // 收入
+    {"工资", 1, "gongzi", "#4CAF50"},   {"兼职", 1, "jianzhi", "#8BC34A"},
+    {"投资", 1, "touzi", "#CDDC39"},    {"副业", 1, "fuye", "#FFEB3B"},
+    {"红包", 1, "hongbao", "#FFC107"},  {"意外收入", 1, "yiwaishouru", "#FF9800"},
+    {"奖金", 1, "", ""}, {"福利", 1, "", ""},
+};
+}
+
+CategoryRegistry* CategoryRegistry::getInstance() {
+    if (m_instance == nullptr) {
+        m_instanceMutex.lock();
+        if (m_instance == nullptr) {
+            m_instance = new CategoryRegistry();
+        }
+        m_instanceMutex.unlock();
+    }
+    return m_instance;
+}
+
+CategoryRegistry::CategoryRegistry() {
+    for (const PresetCategory& preset : kPresets) {
+        int id = internLocked(QString::fromUtf8(preset.name), preset.type);
+        CategoryInfo& info = m_infos[id];
+        info.icon = QString::fromLatin1(preset.icon);
+        if (preset.color[0] != '\0') {
+            info.color = QString::fromLatin1(preset.color);
+        }
+    }
+}
+
+// ============ 登记与查询 ============
+int CategoryRegistry::intern(const QString& name, int type) {
+    {
+        QReadLocker locker(&m_lock);
+        auto it = m_ids.constFind(name);
+        if (it != m_ids.constEnd() && (type < 0 || m_infos.at(it.value()).type >= 0)) {
+            return it.value();
+        }
+    }
+    QWriteLocker locker(&m_lock);
+    return internLocked(name, type);
+}
+
+int CategoryRegistry::internLocked(const QString& name, int type) {
+    auto it = m_ids.constFind(name);
+    if (it != m_ids.constEnd()) {
+        CategoryInfo& info = m_infos[it.value()];
+        if (info.type < 0) info.type = type;
+        return info.id;
+    }
+    CategoryInfo info;
+    info.id = m_infos.size();
+    info.name = name;
+    info.color = QString::fromLatin1(kDefaultColor);
+    info.type = type;
+    m_infos.append(info);
+    m_ids.insert(name, info.id);
+    return info.id;
+}
+
+int CategoryRegistry::idOf(const QString& name) const {
+    QReadLocker locker(&m_lock);
+    return m_ids.value(name, -1);
+}
+
+int CategoryRegistry::size() const {
+    QReadLocker locker(&m_lock);
+    return m_infos.size();
+}
+
+CategoryInfo CategoryRegistry::info(int id) const {
+    QReadLocker locker(&m_lock);
+    return (id >= 0 && id < m_infos.size()) ? m_infos.at(id) : CategoryInfo();
+}
+
+QString CategoryRegistry::name(int id) const {
+    QReadLocker locker(&m_lock);
+    return (id >= 0 && id < m_infos.size()) ? m_infos.at(id).name : QString();
+}
+
+QString CategoryRegistry::color(int id) const {
+    QReadLocker locker(&m_lock);
+    return (id >= 0 && id < m_infos.size()) ? m_infos.at(id).color : QString::fromLatin1(kDefaultColor);
+}
+
+QString CategoryRegistry::icon(int id) const {
+    QReadLocker locker(&m_lock);
+    return (id >= 0 && id < m_infos.size()) ? m_infos.at(id).icon : QString();
+}
+
+int CategoryRegistry::type(int id) const {
+    QReadLocker locker(&m_lock);
+    return (id >= 0 && id < m_infos.size()) ? m_infos.at(id).type : -1;
+}
+
+void CategoryRegistry::loadFromDatabase() {
+    QSqlQuery query = SqliteHelper::getInstance()->executeQuery(
+        "SELECT name, type, icon, color FROM bill_category WHERE is_deleted = 0");
+    int count = 0;
+    QWriteLocker locker(&m_lock);
+    while (query.next()) {
+        QString name = query.value(0).toString();
+        if (name.isEmpty()) continue;
+        CategoryInfo& info = m_infos[internLocked(name, query.value(1).toInt())];
+        // 预设值优先，数据库只补全缺省的图标和颜色
+        QString icon = query.value(2).toString();
+        QString color = query.value(3).toString();
+        if (info.icon.isEmpty() && !icon.isEmpty()) info.icon = icon;
+        if (info.color == QString::fromLatin1(kDefaultColor) && !color.isEmpty()) info.color = color;
+        ++count;
+    }
+    query.finish();
+    qDebug() << "分类注册表已载入" << count << "条 bill_category 记录，共" << m_infos.size() << "个分类";
+}
+
+// ============ 服务端 bill_category.id 缓存 ============
+int CategoryRegistry::billCategoryId(int userId, int categoryId) const {
+    QReadLocker locker(&m_lock);
+    return m_billCategoryIds.value(billKey(userId, categoryId), -1);
+}
+
+void CategoryRegistry::setBillCategoryId(int userId, int categoryId, int billCategoryId) {
+    QWriteLocker locker(&m_lock);
+    m_billCategoryIds.insert(billKey(userId, categoryId), billCategoryId);
+}
+
+void CategoryRegistry::clearBillCategoryIds() {
+    QWriteLocker locker(&m_lock);
+    m_billCategoryIds.clear();
+}
+
+quint64 CategoryRegistry::billKey(int userId, int categoryId) {
+    return (quint64(quint32(userId)) << 32) | quint32(categoryId);
+}
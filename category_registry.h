@@ -0,0 +1,68 @@
+#ifndef CATEGORY_REGISTRY_H
+#define CATEGORY_REGISTRY_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QMutex>
+#include <QReadWriteLock>
+
+// 分类的展示属性
+struct CategoryInfo {
+    int id = -1;                // 注册表内的编号（从 0 开始连续分配）
+    QString name;
+    QString color;              // 统计图表颜色
+    QString icon;               // 图标资源文件名（拼音，无后缀）
+    int type = -1;              // 0=支出 1=收入 -1=未知
+};
+
+/**
+ * @brief 分类注册表 - 进程内单例（客户端与服务端共用），把分类名映射为从 0 开始的连续编号。
+ *        预设分类在构造时登记，bill_category 中的分类由 loadFromDatabase 登记，
+ *        其余分类名在首次出现时登记。按编号取颜色、图标、收支类型都是数组下标访问，
+ *        汇总可以直接用按编号索引的数组代替以分类名为键的映射。编号只增不减，进程内稳定。
+ */
+class CategoryRegistry
+{
+public:
+    static CategoryRegistry* getInstance();
+
+    // 返回分类名的编号，未登记时登记并分配新编号；type 用于补全未知的收支类型
+    int intern(const QString& name, int type = -1);
+    // 只查询，不登记；未登记返回 -1
+    int idOf(const QString& name) const;
+    // 已登记的分类数（有效编号为 0 ~ size()-1）
+    int size() const;
+
+    CategoryInfo info(int id) const;
+    QString name(int id) const;
+    QString color(int id) const;
+    QString icon(int id) const;
+    int type(int id) const;
+
+    // 从 bill_category 登记全部未删除的分类，并用其中的颜色、图标补全缺省值
+    void loadFromDatabase();
+
+    // ============ 服务端 bill_category.id 缓存 ============
+    // 查询 (用户, 分类编号) 对应的 bill_category.id，未缓存返回 -1
+    int billCategoryId(int userId, int categoryId) const;
+    void setBillCategoryId(int userId, int categoryId, int billCategoryId);
+    // bill_category 被修改或删除后调用
+    void clearBillCategoryIds();
+
+private:
+    CategoryRegistry();
+    static CategoryRegistry* m_instance;
+    static QMutex m_instanceMutex;
+
+    // 要求已持有写锁
+    int internLocked(const QString& name, int type);
+    static quint64 billKey(int userId, int categoryId);
+
+    mutable QReadWriteLock m_lock;
+    QList<CategoryInfo> m_infos;        // 下标即编号
+    QHash<QString, int> m_ids;
+    QHash<quint64, int> m_billCategoryIds;
+};
+
+#endif // CATEGORY_REGISTRY_H
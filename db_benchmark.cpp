@@ -0,0 +1,516 @@
+#include "db_benchmark.h"
+#include "account_manager.h"
+#include "sqlite_helper.h"
+#include "account_record.h"
+#include "record_columns.h"
+#include "timestamp_parser.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QVariantList>
+#include <QDebug>
+
+namespace {
+// 每批插入的行数
+const int kInsertChunk = 10000;
+
+const QStringList kCategories = {"餐饮", "服饰", "日用", "数码", "交通", "娱乐", "医疗", "学习", "工资", "其他"};
+}
+
+QList<DbBenchmark::DecodeResult> DbBenchmark::runRecordDecode(int rowCount) {
+    QList<DecodeResult> results;
+    QString connectionName = "account_book_benchmark";
+    QString filePath = QDir::tempPath() + QString("/account_book_benchmark_%1.db")
+                                              .arg(QCoreApplication::applicationPid());
+    QFile::remove(filePath);
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(filePath);
+        if (!db.open()) {
+            qDebug() << "基准测试数据库打开失败：" << db.lastError().text();
+        } else if (populate(connectionName, rowCount, QDateTime::currentDateTime(), 90)) {
+            // 先各跑一遍预热页缓存，再正式计时
+            decodeByName(connectionName);
+            results << decodeByName(connectionName);
+            decodeByPosition(connectionName);
+            results << decodeByPosition(connectionName);
+
+            printResults(results, "按位置解码");
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    QFile::remove(filePath);
+    return results;
+}
+
+bool DbBenchmark::populate(const QString& connectionName, int rowCount, const QDateTime& newest, int spacingSecs) {
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    QSqlQuery query(db);
+    // 临时库不需要持久性，关闭日志与同步以加快生成
+    query.exec("PRAGMA journal_mode = OFF");
+    query.exec("PRAGMA synchronous = OFF");
+
+    // 与正式库 account_record 的结构一致
+    QString createTable = R"(
+        CREATE TABLE account_record (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            user_id INTEGER NOT NULL,
+            bill_date TEXT,
+            amount REAL NOT NULL,
+            type INTEGER DEFAULT 0,
+            category TEXT,
+            remark TEXT,
+            description TEXT,
+            voucher_path TEXT,
+            is_deleted INTEGER DEFAULT 0,
+            delete_time TEXT,
+            create_time TEXT NOT NULL,
+            modify_time TEXT,
+            bill_ts INTEGER GENERATED ALWAYS AS (CAST(strftime('%s', create_time) AS INTEGER)) VIRTUAL
+        )
+    )";
+    if (!query.exec(createTable)) {
+        qDebug() << "基准测试建表失败：" << query.lastError().text();
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    db.transaction();
+    query.prepare(R"(
+        INSERT INTO account_record (user_id, bill_date, amount, type, category, remark,
+                                    description, voucher_path, is_deleted, create_time, modify_time)
+        VALUES (?, ?, ?, ?, ?, ?, ?, '', 0, ?, ?)
+    )");
+    for (int start = 0; start < rowCount; start += kInsertChunk) {
+        int count = qMin(kInsertChunk, rowCount - start);
+        QVariantList userIds, billDates, amounts, types, categories, remarks, descriptions, createTimes, modifyTimes;
+        for (int i = start; i < start + count; ++i) {
+            bool income = (i % 10 == 0);
+            QString time = newest.addSecs(-qint64(i) * spacingSecs).toString("yyyy-MM-dd HH:mm:ss");
+            QString remark = QString("备注 %1").arg(i);
+            userIds << 1;
+            billDates << time;
+            amounts << (income ? 5000.0 + i % 1000 : -(10.0 + i % 500));
+            types << (income ? 1 : 0);
+            categories << kCategories.at(i % kCategories.size());
+            remarks << remark;
+            descriptions << remark;
+            createTimes << time;
+            modifyTimes << time;
+        }
+        query.addBindValue(userIds);
+        query.addBindValue(billDates);
+        query.addBindValue(amounts);
+        query.addBindValue(types);
+        query.addBindValue(categories);
+        query.addBindValue(remarks);
+        query.addBindValue(descriptions);
+        query.addBindValue(createTimes);
+        query.addBindValue(modifyTimes);
+        if (!query.execBatch()) {
+            qDebug() << "基准测试数据生成失败：" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    db.commit();
+    // 与正式库的记录索引一致，两种解码方式走相同的执行计划，差异只来自解码
+    if (!query.exec("CREATE INDEX idx_account_user_deleted_time_id_cat ON account_record(user_id, is_deleted, create_time, id, amount, category)")) {
+        qDebug() << "基准测试建索引失败：" << query.lastError().text();
+        return false;
+    }
+    qDebug() << "基准测试数据生成完成：" << rowCount << "行，耗时" << timer.elapsed() << "ms";
+    return true;
+}
+
+QList<DbBenchmark::DecodeResult> DbBenchmark::runMonthlyStat(int rowCount) {
+    QList<DecodeResult> results;
+    QString connectionName = "account_book_benchmark_month";
+    QString filePath = QDir::tempPath() + QString("/account_book_benchmark_month_%1.db")
+                                              .arg(QCoreApplication::applicationPid());
+    QFile::remove(filePath);
+
+    // 全部记录落在同一个月内
+    QDate month(2024, 3, 1);
+    QDateTime newest(month.addDays(month.daysInMonth() - 1), QTime(23, 59, 0));
+    int spacingSecs = qMax(1, int(qint64(month.daysInMonth()) * 86400 / qMax(1, rowCount)));
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(filePath);
+        if (!db.open()) {
+            qDebug() << "基准测试数据库打开失败：" << db.lastError().text();
+        } else if (populate(connectionName, rowCount, newest, spacingSecs) && buildDailyRollup(connectionName)) {
+            qint64 byRows = 0;
+            qint64 bySql = 0;
+            aggregateByRows(connectionName, month, byRows);
+            results << aggregateByRows(connectionName, month, byRows);
+            aggregateBySql(connectionName, month, bySql);
+            results << aggregateBySql(connectionName, month, bySql);
+
+            printResults(results, "读取每日汇总");
+            if (byRows != bySql) {
+                qDebug() << "月度统计结果不一致：" << byRows << bySql;
+            }
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    QFile::remove(filePath);
+    return results;
+}
+
+QList<DbBenchmark::DecodeResult> DbBenchmark::runTrend(int months, int rowCount) {
+    QList<DecodeResult> results;
+    QString connectionName = "account_book_benchmark_trend";
+    QString filePath = QDir::tempPath() + QString("/account_book_benchmark_trend_%1.db")
+                                              .arg(QCoreApplication::applicationPid());
+    QFile::remove(filePath);
+
+    // 记录均匀分布在 [firstMonth, firstMonth + months) 内
+    QDate firstMonth(2022, 1, 1);
+    QDate lastDay = firstMonth.addMonths(months).addDays(-1);
+    QDateTime newest(lastDay, QTime(23, 59, 0));
+    int spacingSecs = qMax(1, int((firstMonth.daysTo(lastDay) + 1) * 86400 / qMax(1, rowCount)));
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(filePath);
+        if (!db.open()) {
+            qDebug() << "基准测试数据库打开失败：" << db.lastError().text();
+        } else if (populate(connectionName, rowCount, newest, spacingSecs) && buildDailyRollup(connectionName)) {
+            qint64 byMonth = 0;
+            qint64 byGroup = 0;
+            trendByMonth(connectionName, firstMonth, months, byMonth);
+            results << trendByMonth(connectionName, firstMonth, months, byMonth);
+            trendByGroup(connectionName, firstMonth, months, byGroup);
+            results << trendByGroup(connectionName, firstMonth, months, byGroup);
+
+            printResults(results, "一次分组查询");
+            if (byMonth != byGroup) {
+                qDebug() << "趋势结果不一致：" << byMonth << byGroup;
+            }
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    QFile::remove(filePath);
+    return results;
+}
+
+bool DbBenchmark::buildDailyRollup(const QString& connectionName) {
+    // 与正式库相同的汇总表与触发器，数据生成后一次性汇总
+    QSqlQuery query(QSqlDatabase::database(connectionName, false));
+    QStringList stmts = SqliteHelper::dailyRollupSchema();
+    stmts << "INSERT INTO daily_rollup(user_id, day, category, type, sum_cents, count) " + SqliteHelper::dailyRollupScanSql();
+    for (const QString& sql : stmts) {
+        if (!query.exec(sql)) {
+            qDebug() << "基准测试生成每日汇总失败：" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+// 旧方式：读出整月记录，构建列式快照后按日、按分类汇总
+DbBenchmark::DecodeResult DbBenchmark::aggregateByRows(const QString& connectionName, const QDate& month,
+                                                       qint64& balanceCents) {
+    DecodeResult result;
+    result.name = "整月读取 + 内存汇总";
+
+    QSqlQuery query(QSqlDatabase::database(connectionName, false));
+    query.setForwardOnly(true);
+    QElapsedTimer timer;
+    timer.start();
+    query.prepare(QString("SELECT %1 FROM account_record WHERE user_id = 1 AND is_deleted = 0 "
+                          "AND create_time >= ? AND create_time <= ? ORDER BY create_time DESC, id DESC")
+                      .arg(RecordRow::selectColumns()));
+    query.addBindValue(month.toString("yyyy-MM-dd 00:00:00"));
+    query.addBindValue(month.addMonths(1).addDays(-1).toString("yyyy-MM-dd 23:59:59"));
+    query.exec();
+    QList<AccountRecord> records;
+    RecordRow row(query);
+    while (query.next()) {
+        records.append(row.toRecord());
+    }
+    RecordColumns columns = RecordColumns::fromRecords(records);
+    QList<qint64> dailyIncome;
+    QList<qint64> dailyExpense;
+    columns.sumByDay(TimestampParser::dayStart(month), month.daysInMonth(), dailyIncome, dailyExpense);
+    QList<qint64> expenseByCategory = columns.sumByCategory(true);
+    QList<qint64> incomeByCategory = columns.sumByCategory(false);
+    balanceCents = 0;
+    for (int id = 0; id < columns.categoryCount(); ++id) {
+        balanceCents += incomeByCategory[id] - expenseByCategory[id];
+    }
+    qint64 elapsedNs = timer.nsecsElapsed();
+    result.elapsedMs = elapsedNs / 1000000;
+    result.rows = records.size();
+    result.rowsPerSecond = elapsedNs > 0 ? result.rows * 1e9 / elapsedNs : 0;
+    return result;
+}
+
+// 新方式：与 AccountManager::queryMonthlyTotals 相同，从每日汇总表按日、按分类取回合计
+DbBenchmark::DecodeResult DbBenchmark::aggregateBySql(const QString& connectionName, const QDate& month,
+                                                      qint64& balanceCents) {
+    DecodeResult result;
+    result.name = "daily_rollup 按日、按分类汇总";
+
+    QSqlQuery query(QSqlDatabase::database(connectionName, false));
+    query.setForwardOnly(true);
+    QElapsedTimer timer;
+    timer.start();
+    balanceCents = 0;
+    for (bool byCategory : {false, true}) {
+        query.prepare(AccountManager::monthlyTotalsSql(byCategory));
+        query.addBindValue(1);
+        query.addBindValue(month.toString("yyyy-MM-dd"));
+        query.addBindValue(month.addMonths(1).addDays(-1).toString("yyyy-MM-dd"));
+        query.exec();
+        while (query.next()) {
+            if (byCategory) {
+                balanceCents += query.value(1).toLongLong() - query.value(2).toLongLong();
+            }
+        }
+    }
+    // 聚合很快，按纳秒计时；吞吐量按覆盖的记录数计算，与旧方式可比
+    qint64 elapsedNs = timer.nsecsElapsed();
+    result.elapsedMs = elapsedNs / 1000000;
+    QSqlQuery count(QSqlDatabase::database(connectionName, false));
+    count.exec("SELECT COUNT(*) FROM account_record");
+    result.rows = count.next() ? count.value(0).toLongLong() : 0;
+    result.rowsPerSecond = elapsedNs > 0 ? result.rows * 1e9 / elapsedNs : 0;
+    return result;
+}
+
+// 旧方式：逐月执行 queryMonthlyTotals 的按分类聚合，每月一次查询
+DbBenchmark::DecodeResult DbBenchmark::trendByMonth(const QString& connectionName, const QDate& firstMonth,
+                                                    int months, qint64& balanceCents) {
+    DecodeResult result;
+    result.name = QString("逐月查询 %1 次").arg(months);
+
+    QSqlQuery query(QSqlDatabase::database(connectionName, false));
+    query.setForwardOnly(true);
+    QElapsedTimer timer;
+    timer.start();
+    balanceCents = 0;
+    for (int i = 0; i < months; ++i) {
+        QDate month = firstMonth.addMonths(i);
+        query.prepare(AccountManager::monthlyTotalsSql(true));
+        query.addBindValue(1);
+        query.addBindValue(month.toString("yyyy-MM-dd"));
+        query.addBindValue(month.addMonths(1).addDays(-1).toString("yyyy-MM-dd"));
+        query.exec();
+        while (query.next()) {
+            balanceCents += query.value(1).toLongLong() - query.value(2).toLongLong();
+        }
+    }
+    qint64 elapsedNs = timer.nsecsElapsed();
+    result.elapsedMs = elapsedNs / 1000000;
+    result.rows = recordCount(connectionName);
+    result.rowsPerSecond = elapsedNs > 0 ? result.rows * 1e9 / elapsedNs : 0;
+    return result;
+}
+
+// 新方式：与 AccountManager::queryPeriodTotals 相同，按 (月, 分类) 一次分组取回全部月份
+DbBenchmark::DecodeResult DbBenchmark::trendByGroup(const QString& connectionName, const QDate& firstMonth,
+                                                    int months, qint64& balanceCents) {
+    DecodeResult result;
+    result.name = "按月一次分组查询";
+
+    QSqlQuery query(QSqlDatabase::database(connectionName, false));
+    query.setForwardOnly(true);
+    QElapsedTimer timer;
+    timer.start();
+    balanceCents = 0;
+    query.prepare(AccountManager::periodTotalsSql(PeriodGranularity::Month));
+    query.addBindValue(1);
+    query.addBindValue(firstMonth.toString("yyyy-MM-dd"));
+    query.addBindValue(firstMonth.addMonths(months).addDays(-1).toString("yyyy-MM-dd"));
+    query.exec();
+    while (query.next()) {
+        balanceCents += query.value(2).toLongLong() - query.value(3).toLongLong();
+    }
+    qint64 elapsedNs = timer.nsecsElapsed();
+    result.elapsedMs = elapsedNs / 1000000;
+    result.rows = recordCount(connectionName);
+    result.rowsPerSecond = elapsedNs > 0 ? result.rows * 1e9 / elapsedNs : 0;
+    return result;
+}
+
+qint64 DbBenchmark::recordCount(const QString& connectionName) {
+    QSqlQuery count(QSqlDatabase::database(connectionName, false));
+    count.exec("SELECT COUNT(*) FROM account_record");
+    return count.next() ? count.value(0).toLongLong() : 0;
+}
+
+// 旧方式：SELECT * 后逐行按列名取值，并对分类/备注做兼容回退
+DbBenchmark::DecodeResult DbBenchmark::decodeByName(const QString& connectionName) {
+    DecodeResult result;
+    result.name = "SELECT * + 按列名解码";
+
+    QSqlQuery query(QSqlDatabase::database(connectionName, false));
+    query.setForwardOnly(true);
+    QElapsedTimer timer;
+    timer.start();
+    query.exec("SELECT * FROM account_record WHERE user_id = 1 AND is_deleted = 0 ORDER BY create_time DESC");
+    while (query.next()) {
+        AccountRecord record;
+        record.setId(query.value("id").toInt());
+        record.setUserId(query.value("user_id").toInt());
+        record.setAmount(query.value("amount").toDouble());
+        QString category = query.value("category").toString();
+        if (category.isEmpty()) {
+            category = query.value("type").toString();
+        }
+        record.setType(category);
+        record.setRemark(query.value("remark").toString());
+        if (record.getRemark().isEmpty()) {
+            record.setRemark(query.value("description").toString());
+        }
+        record.setVoucherPath(query.value("voucher_path").toString());
+        record.setIsDeleted(query.value("is_deleted").toInt());
+        record.setDeleteTime(query.value("delete_time").toString());
+        record.setCreateTime(query.value("create_time").toString());
+        record.setModifyTime(query.value("modify_time").toString());
+        ++result.rows;
+    }
+    result.elapsedMs = timer.elapsed();
+    result.rowsPerSecond = result.elapsedMs > 0 ? result.rows * 1000.0 / result.elapsedMs : 0;
+    return result;
+}
+
+// 新方式：只查需要的列，列位置每个结果集解析一次（与 AccountManager 一致）
+DbBenchmark::DecodeResult DbBenchmark::decodeByPosition(const QString& connectionName) {
+    DecodeResult result;
+    result.name = "列投影 + 按位置解码";
+
+    QSqlQuery query(QSqlDatabase::database(connectionName, false));
+    query.setForwardOnly(true);
+    QElapsedTimer timer;
+    timer.start();
+    query.exec(QString("SELECT %1 FROM account_record WHERE user_id = 1 AND is_deleted = 0 ORDER BY create_time DESC")
+                   .arg(RecordRow::selectColumns()));
+    RecordRow row(query);
+    while (query.next()) {
+        AccountRecord record = row.toRecord();
+        Q_UNUSED(record);
+        ++result.rows;
+    }
+    result.elapsedMs = timer.elapsed();
+    result.rowsPerSecond = result.elapsedMs > 0 ? result.rows * 1000.0 / result.elapsedMs : 0;
+    return result;
+}
+
+QList<DbBenchmark::DecodeResult> DbBenchmark::runTimestampParse(int count) {
+    // 与账单时间一样按时间倒序生成，大部分带秒，少量只到分钟或只有日期
+    QStringList texts;
+    texts.reserve(count);
+    QDateTime base = QDateTime::currentDateTime();
+    for (int i = 0; i < count; ++i) {
+        QDateTime time = base.addSecs(-qint64(i) * 90);
+        if (i % 10 == 8) {
+            texts << time.toString("yyyy-MM-dd HH:mm");
+        } else if (i % 10 == 9) {
+            texts << time.toString("yyyy-MM-dd");
+        } else {
+            texts << time.toString("yyyy-MM-dd HH:mm:ss");
+        }
+    }
+
+    QList<DecodeResult> results;
+    QList<QDateTime> legacy;
+    QList<QDateTime> parsed;
+    // 先各跑一遍预热，再正式计时
+    parseByQDateTime(texts, legacy);
+    results << parseByQDateTime(texts, legacy);
+    parseByTimestampParser(texts, parsed);
+    results << parseByTimestampParser(texts, parsed);
+    printResults(results, "TimestampParser 解析");
+
+    // 两种方式解析出的日期与钟点应完全一致
+    int mismatches = 0;
+    for (int i = 0; i < count; ++i) {
+        if (legacy.at(i).date() != parsed.at(i).date() || legacy.at(i).time() != parsed.at(i).time()) {
+            if (mismatches++ < 5) {
+                qDebug() << "解析结果不一致：" << texts.at(i) << legacy.at(i) << parsed.at(i);
+            }
+        }
+    }
+    if (mismatches > 0) {
+        qDebug() << "时间解析结果不一致" << mismatches << "条";
+    }
+    return results;
+}
+
+// 旧方式：与原先列表渲染中的 parseDateTime 一致，按格式依次尝试 QDateTime::fromString
+DbBenchmark::DecodeResult DbBenchmark::parseByQDateTime(const QStringList& texts, QList<QDateTime>& parsed) {
+    DecodeResult result;
+    result.name = "QDateTime::fromString";
+    parsed.clear();
+    parsed.reserve(texts.size());
+
+    QElapsedTimer timer;
+    timer.start();
+    for (const QString& text : texts) {
+        QDateTime dt = QDateTime::fromString(text, "yyyy-MM-dd HH:mm:ss");
+        if (!dt.isValid()) {
+            dt = QDateTime::fromString(text, "yyyy-MM-dd HH:mm");
+        }
+        if (!dt.isValid()) {
+            dt = QDateTime::fromString(text, Qt::ISODate);
+        }
+        if (!dt.isValid()) {
+            QDate date = QDate::fromString(text, "yyyy-MM-dd");
+            if (date.isValid()) {
+                dt = QDateTime(date, QTime(0, 0));
+            }
+        }
+        parsed.append(dt);
+        ++result.rows;
+    }
+    result.elapsedMs = timer.elapsed();
+    result.rowsPerSecond = result.elapsedMs > 0 ? result.rows * 1000.0 / result.elapsedMs : 0;
+    return result;
+}
+
+// 新方式：固定格式解析为秒数，展示时再换回 QDateTime
+DbBenchmark::DecodeResult DbBenchmark::parseByTimestampParser(const QStringList& texts, QList<QDateTime>& parsed) {
+    DecodeResult result;
+    result.name = "TimestampParser";
+    parsed.clear();
+    parsed.reserve(texts.size());
+
+    QElapsedTimer timer;
+    timer.start();
+    for (const QString& text : texts) {
+        bool ok = false;
+        qint64 secs = TimestampParser::parse(text, &ok);
+        parsed.append(ok ? TimestampParser::toDateTime(secs) : QDateTime());
+        ++result.rows;
+    }
+    result.elapsedMs = timer.elapsed();
+    result.rowsPerSecond = result.elapsedMs > 0 ? result.rows * 1000.0 / result.elapsedMs : 0;
+    return result;
+}
+
+void DbBenchmark::printResults(const QList<DecodeResult>& results, const QString& speedupLabel) {
+    for (const DecodeResult& result : results) {
+        qDebug().noquote() << QString("%1：%2 行，%3 ms，%4 行/秒")
+                                  .arg(result.name).arg(result.rows).arg(result.elapsedMs)
+                                  .arg(result.rowsPerSecond, 0, 'f', 0);
+    }
+    if (results.size() == 2 && results[0].rowsPerSecond > 0) {
+        qDebug().noquote() << QString("%1提速 %2 倍")
+                                  .arg(speedupLabel)
+                                  .arg(results[1].rowsPerSecond / results[0].rowsPerSecond, 0, 'f', 2);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef DB_BENCHMARK_H
+#define DB_BENCHMARK_H
+
+#include <QString>
+#include <QList>
+#include <QDate>
+#include <QDateTime>
+
+/**
+ * @brief 数据库微基准 - 在临时库中生成账单数据，对比不同行解码方式的吞吐量
+ *        （通过 --benchmark [行数] 启动参数运行，不会触碰正式数据库）
+ */
+class DbBenchmark
+{
+public:
+    struct DecodeResult {
+        QString name;              // 解码方式
+        qint64 rows = 0;           // 解码行数
+        qint64 elapsedMs = 0;      // 耗时（毫秒）
+        double rowsPerSecond = 0;  // 每秒解码行数
+    };
+
+    // 生成 rowCount 行 account_record 数据，依次以
+    // “SELECT * + 按列名取值 + 逐行兼容回退”（旧）与“列投影 + 按位置取值”（新）解码
+    static QList<DecodeResult> runRecordDecode(int rowCount = 1000000);
+    // 生成 count 个记账时间文本（秒 / 分钟 / 仅日期三种格式混合），依次以
+    // “QDateTime::fromString 逐个格式尝试”（旧）与 TimestampParser（新）解析，并校验两者结果一致
+    static QList<DecodeResult> runTimestampParse(int count = 1000000);
+    // 在同一个月内生成 rowCount 行数据，依次以“整月读取记录 + 内存汇总”（旧）与
+    // “读取每日汇总表 daily_rollup”（新）计算月度统计，并校验两者合计一致
+    static QList<DecodeResult> runMonthlyStat(int rowCount = 50000);
+    // 在 months 个月内生成 rowCount 行数据，依次以“逐月查询每日汇总”（旧）与
+    // “按月一次分组查询”（新）计算按月、按分类的趋势，并校验两者合计一致
+    static QList<DecodeResult> runTrend(int months = 36, int rowCount = 200000);
+
+private:
+    // 从 newest 起每隔 spacingSecs 秒倒序生成一行
+    static bool populate(const QString& connectionName, int rowCount, const QDateTime& newest, int spacingSecs);
+    static DecodeResult decodeByName(const QString& connectionName);
+    static DecodeResult decodeByPosition(const QString& connectionName);
+    static DecodeResult parseByQDateTime(const QStringList& texts, QList<QDateTime>& parsed);
+    static DecodeResult parseByTimestampParser(const QStringList& texts, QList<QDateTime>& parsed);
+    static bool buildDailyRollup(const QString& connectionName);
+    static DecodeResult aggregateByRows(const QString& connectionName, const QDate& month, qint64& balanceCents);
+    static DecodeResult aggregateBySql(const QString& connectionName, const QDate& month, qint64& balanceCents);
+    static DecodeResult trendByMonth(const QString& connectionName, const QDate& firstMonth, int months,
+                                     qint64& balanceCents);
+    static DecodeResult trendByGroup(const QString& connectionName, const QDate& firstMonth, int months,
+                                     qint64& balanceCents);
+    static qint64 recordCount(const QString& connectionName);
+    static void printResults(const QList<DecodeResult>& results, const QString& speedupLabel);
+};
+
+#endif // DB_BENCHMARK_H
@@ -0,0 +1,117 @@
+#include "db_maintenance.h"
+#include "sqlite_helper.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QStringList>
+#include <QDebug>
+
+namespace {
+// 每次 incremental_vacuum 回收的页数，保证单步足够短
+const int kVacuumPagesPerStep = 64;
+// PRAGMA optimize 的最小间隔
+const qint64 kOptimizeIntervalMs = 60 * 60 * 1000;
+}
+
+DbMaintenance* DbMaintenance::m_instance = nullptr;
+
+DbMaintenance* DbMaintenance::getInstance() {
+    if (!m_instance) {
+        m_instance = new DbMaintenance();
+    }
+    return m_instance;
+}
+
+DbMaintenance::DbMaintenance(QObject *parent) : QObject(parent) {
+    m_timer = new QTimer(this);
+    connect(m_timer, &QTimer::timeout, this, &DbMaintenance::onTimerTimeout);
+}
+
+void DbMaintenance::start(int checkInterval) {
+    m_timer->start(checkInterval);
+    qDebug() << "数据库维护调度已开启，检查间隔:" << checkInterval / 1000 << "秒";
+}
+
+void DbMaintenance::stop() {
+    m_timer->stop();
+    qDebug() << "数据库维护调度已停止";
+}
+
+void DbMaintenance::onTimerTimeout() {
+    // 有业务读写时让路，等下一次检查
+    if (SqliteHelper::getInstance()->idleMsecs() < m_idleThresholdMs) return;
+    runSlice();
+}
+
+void DbMaintenance::runSlice() {
+    if (!m_running.testAndSetOrdered(0, 1)) return;
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    bool runOptimize = now - m_lastOptimizeMs >= kOptimizeIntervalMs;
+    if (runOptimize) m_lastOptimizeMs = now;
+
+    int budgetMs = m_sliceBudgetMs;
+    double threshold = m_fragmentationThreshold;
+    SqliteHelper::getInstance()->runAsync<QString>([this, budgetMs, threshold, runOptimize]() {
+        QString summary = doSlice(budgetMs, threshold, runOptimize);
+        m_running.storeRelease(0);
+        emit sliceFinished(summary);
+        return summary;
+    });
+}
+
+QString DbMaintenance::doSlice(int budgetMs, double fragmentationThreshold, bool runOptimize) {
+    SqliteHelper* helper = SqliteHelper::getInstance();
+    QElapsedTimer timer;
+    timer.start();
+    QStringList done;
+
+    SqliteHelper::SpaceMetrics before = helper->getSpaceMetrics();
+    // 维护语句直接在本线程连接上执行，不计入业务读写
+    QSqlQuery query(helper->getDatabase());
+
+    // 1. 回收空闲页：每步少量页，超出预算即停，剩余的留给下一个时间片
+    if (before.autoVacuum == 2 && before.freelistCount > 0
+        && before.fragmentation >= fragmentationThreshold) {
+        int steps = 0;
+        while (timer.elapsed() < budgetMs) {
+            if (!query.exec(QString("PRAGMA incremental_vacuum(%1)").arg(kVacuumPagesPerStep))) {
+                qDebug() << "增量回收失败：" << query.lastError().text();
+                break;
+            }
+            // incremental_vacuum 每步回收一页，需要一直步进到结束
+            while (query.next()) {}
+            ++steps;
+            if (helper->getSpaceMetrics().freelistCount == 0) break;
+        }
+        done << QString("incremental_vacuum x%1").arg(steps);
+    }
+
+    // 2. 更新统计信息（只分析统计过期的表）
+    if (runOptimize && timer.elapsed() < budgetMs) {
+        if (query.exec("PRAGMA optimize")) {
+            done << "optimize";
+        } else {
+            qDebug() << "PRAGMA optimize 失败：" << query.lastError().text();
+        }
+    }
+
+    // 3. PASSIVE 检查点：不等待读写者，能合并多少合并多少
+    if (timer.elapsed() < budgetMs && before.walSizeBytes > 0) {
+        if (query.exec("PRAGMA wal_checkpoint(PASSIVE)") && query.next()) {
+            done << QString("checkpoint %1/%2").arg(query.value(2).toInt()).arg(query.value(1).toInt());
+        }
+    }
+    query.finish();
+
+    SqliteHelper::SpaceMetrics after = helper->getSpaceMetrics();
+    QString summary = QString("维护时间片 %1ms [%2]：空闲页 %3 -> %4（%5% -> %6%），WAL %7 KB -> %8 KB")
+                          .arg(timer.elapsed())
+                          .arg(done.isEmpty() ? QString("无需维护") : done.join(", "))
+                          .arg(before.freelistCount).arg(after.freelistCount)
+                          .arg(before.fragmentation * 100, 0, 'f', 1).arg(after.fragmentation * 100, 0, 'f', 1)
+                          .arg(before.walSizeBytes / 1024).arg(after.walSizeBytes / 1024);
+    qDebug() << summary;
+    return summary;
+}
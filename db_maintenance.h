@@ -0,0 +1,55 @@
+#ifndef DB_MAINTENANCE_H
+#define DB_MAINTENANCE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QString>
+#include <QAtomicInteger>
+
+/**
+ * @brief 数据库维护调度器 - 单例，在数据库空闲时于后台执行限时的小段维护：
+ *        incremental_vacuum 回收空闲页、PRAGMA optimize 更新统计信息、PASSIVE 检查点
+ */
+class DbMaintenance : public QObject
+{
+    Q_OBJECT
+public:
+    static DbMaintenance* getInstance();
+
+    // 开始定时检查（每隔 checkInterval 毫秒检查一次是否空闲）
+    void start(int checkInterval = 60000);
+    void stop();
+
+    // 无读写超过该时长（毫秒）才视为空闲，默认 30 秒
+    void setIdleThreshold(int msecs) { m_idleThresholdMs = msecs; }
+    // 单个维护时间片的预算（毫秒），默认 50
+    void setSliceBudget(int msecs) { m_sliceBudgetMs = msecs; }
+    // 空闲页占比超过该值才回收，默认 0.1
+    void setFragmentationThreshold(double ratio) { m_fragmentationThreshold = ratio; }
+
+    // 立即在数据库线程池中执行一个时间片（不检查是否空闲）
+    void runSlice();
+
+signals:
+    // 时间片完成，summary 为本次执行内容与维护前后的空间指标
+    void sliceFinished(const QString& summary);
+
+private slots:
+    void onTimerTimeout();
+
+private:
+    explicit DbMaintenance(QObject *parent = nullptr);
+    static DbMaintenance* m_instance;
+
+    // 在数据库线程中执行的维护内容
+    static QString doSlice(int budgetMs, double fragmentationThreshold, bool runOptimize);
+
+    QTimer* m_timer;
+    int m_idleThresholdMs = 30000;
+    int m_sliceBudgetMs = 50;
+    double m_fragmentationThreshold = 0.1;
+    qint64 m_lastOptimizeMs = 0;
+    QAtomicInteger<int> m_running;
+};
+
+#endif // DB_MAINTENANCE_H
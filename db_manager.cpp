@@ -1,5 +1,6 @@
 #include "db_manager.h"
 #include "sqlite_helper.h"
+#include "category_registry.h"
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QDateTime>
@@ -28,18 +29,18 @@ DBManager* DBManager::getInstance() {
     return m_instance;
 }
 
-bool DBManager::initialize(const QString& localDbPath) {
+bool DBManager::initialize(const QString& localDbPath, const QString& profileName) {
     m_localDb = SqliteHelper::getInstance();
-    bool localOk = m_localDb->openDatabase(localDbPath);
+    bool localOk = m_localDb->openDatabase(localDbPath, profileName);
     if (!localOk) {
         qWarning() << "本地数据库初始化失败: " << m_localDb->getLastError();
     }
 
     // 在 SQLite 模式下，远程数据库也暂时指向同一个实例，或者如果需要分离可以另外处理
     m_remoteDb = SqliteHelper::getInstance();
-    m_isInitialized = true;
-    qDebug() << "DBManager初始化完成 (SQLite模式)";
-    return true;
+    m_isInitialized = localOk;
+    qDebug() << "DBManager初始化" << (localOk ? "完成" : "失败") << "(SQLite模式)";
+    return localOk;
 }
 
 bool DBManager::connectRemoteDatabase(const QString& host, int port,
@@ -146,7 +147,7 @@ QList<BillData> DBManager::getBillByMonth(int userId, int year, int month) {
     QVariantList params;
     params << userId << startDate << endDate;
 
-    QSqlQuery query = m_localDb->executeQueryWithParams(sql, params);
+    SqliteHelper::CachedQuery query = m_localDb->executeQueryWithParams(sql, params);
     while (query.next()) {
         BillData bill;
         bill.id = query.value("id").toInt();
@@ -178,7 +179,7 @@ QList<BillData> DBManager::getBillByDateRange(int userId, const QString& startDa
     QVariantList params;
     params << userId << startDate << endDate;
 
-    QSqlQuery query = m_localDb->executeQueryWithParams(sql, params);
+    SqliteHelper::CachedQuery query = m_localDb->executeQueryWithParams(sql, params);
     while (query.next()) {
         BillData bill;
         bill.id = query.value("id").toInt();
@@ -230,7 +231,7 @@ BillData DBManager::getBillById(int billId) {
     QVariantList params;
     params << billId;
 
-    QSqlQuery query = m_localDb->executeQueryWithParams(sql, params);
+    SqliteHelper::CachedQuery query = m_localDb->executeQueryWithParams(sql, params);
     if (query.next()) {
         bill.id = query.value("id").toInt();
         bill.userId = query.value("user_id").toInt();
@@ -341,7 +342,7 @@ int DBManager::getBillCount(int userId, int year, int month) {
         params << startDate << endDate;
     }
 
-    QSqlQuery query = m_localDb->executeQueryWithParams(sql, params);
+    SqliteHelper::CachedQuery query = m_localDb->executeQueryWithParams(sql, params);
     if (query.next()) {
         return query.value("count").toInt();
     }
@@ -387,7 +388,7 @@ QList<AccountBookData> DBManager::getAccountBooks(int userId) {
     QVariantList params;
     params << userId;
 
-    QSqlQuery query = m_remoteDb->executeQueryWithParams(sql, params);
+    SqliteHelper::CachedQuery query = m_remoteDb->executeQueryWithParams(sql, params);
     while (query.next()) {
         AccountBookData book;
         book.id = query.value("id").toInt();
@@ -413,7 +414,7 @@ AccountBookData DBManager::getAccountBookById(int bookId) {
     QVariantList params;
     params << bookId;
 
-    QSqlQuery query = m_remoteDb->executeQueryWithParams(sql, params);
+    SqliteHelper::CachedQuery query = m_remoteDb->executeQueryWithParams(sql, params);
     if (query.next()) {
         book.id = query.value("id").toInt();
         book.userId = query.value("user_id").toInt();
@@ -505,7 +506,7 @@ QList<BillCategoryData> DBManager::getBillCategories(int userId, int type) {
 
     sql += " ORDER BY sort_order";
 
-    QSqlQuery query = m_remoteDb->executeQueryWithParams(sql, params);
+    SqliteHelper::CachedQuery query = m_remoteDb->executeQueryWithParams(sql, params);
     while (query.next()) {
         BillCategoryData category;
         category.id = query.value("id").toInt();
@@ -532,7 +533,7 @@ BillCategoryData DBManager::getBillCategoryById(int categoryId) {
     QVariantList params;
     params << categoryId;
 
-    QSqlQuery query = m_remoteDb->executeQueryWithParams(sql, params);
+    SqliteHelper::CachedQuery query = m_remoteDb->executeQueryWithParams(sql, params);
     if (query.next()) {
         category.id = query.value("id").toInt();
         category.userId = query.value("user_id").toInt();
@@ -560,6 +561,8 @@ bool DBManager::updateBillCategory(const BillCategoryData& category) {
         return false;
     }
 
+    // 改名后按旧名称缓存的 bill_category.id 已失效
+    CategoryRegistry::getInstance()->clearBillCategoryIds();
     return true;
 }
 
@@ -578,6 +581,8 @@ bool DBManager::deleteBillCategory(int categoryId) {
         return false;
     }
 
+    // 已删除的分类不能再命中缓存
+    CategoryRegistry::getInstance()->clearBillCategoryIds();
     return true;
 }
 
@@ -618,7 +623,7 @@ UserData DBManager::getUserById(int userId) {
     QVariantList params;
     params << userId;
 
-    QSqlQuery query = m_remoteDb->executeQueryWithParams(sql, params);
+    SqliteHelper::CachedQuery query = m_remoteDb->executeQueryWithParams(sql, params);
     if (query.next()) {
         user.id = query.value("id").toInt();
         user.account = query.value("account").toString();
@@ -642,7 +647,7 @@ UserData DBManager::getUserByAccount(const QString& account) {
     QVariantList params;
     params << account;
 
-    QSqlQuery query = m_remoteDb->executeQueryWithParams(sql, params);
+    SqliteHelper::CachedQuery query = m_remoteDb->executeQueryWithParams(sql, params);
     if (query.next()) {
         user.id = query.value("id").toInt();
         user.account = query.value("account").toString();
@@ -28,7 +28,8 @@ public:
      * @param localDbPath SQLite本地数据库路径
      * @return 是否初始化成功
      */
-    bool initialize(const QString& localDbPath = "./account_book.db");
+    bool initialize(const QString& localDbPath = "./account_book.db",
+                    const QString& profileName = "server-throughput");
 
     /**
      * @brief 连接到远程数据库 (SQLite模式下仅做占位)
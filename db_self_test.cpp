@@ -0,0 +1,260 @@
+#include "db_self_test.h"
+#include "account_manager.h"
+#include "account_record.h"
+#include "budget_manager.h"
+#include "statistics_manager.h"
+#include "sqlite_helper.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QDebug>
+
+namespace {
+const QString kReaderConnection = "account_book_self_test_reader";
+
+QString selfTestPath() {
+    return QDir::tempPath() + QString("/account_book_self_test_%1.db").arg(QCoreApplication::applicationPid());
+}
+
+void removeDatabaseFiles(const QString& filePath) {
+    QFile::remove(filePath);
+    QFile::remove(filePath + "-wal");
+    QFile::remove(filePath + "-shm");
+}
+
+// 独立的读取连接：只能看到已提交的写入
+QSqlDatabase readerConnection() {
+    QSqlDatabase db = QSqlDatabase::contains(kReaderConnection)
+                          ? QSqlDatabase::database(kReaderConnection)
+                          : QSqlDatabase::addDatabase("QSQLITE", kReaderConnection);
+    if (!db.isOpen()) {
+        db.setDatabaseName(selfTestPath());
+        if (!db.open()) {
+            qDebug() << "自检读取连接打开失败：" << db.lastError().text();
+        }
+    }
+    return db;
+}
+}
+
+bool DbSelfTest::run() {
+    QString filePath = selfTestPath();
+    removeDatabaseFiles(filePath);
+
+    SqliteHelper* dbHelper = SqliteHelper::getInstance();
+    if (!dbHelper->openDatabase(filePath, "interactive-client")) {
+        qDebug() << "自检数据库打开失败：" << dbHelper->getLastError();
+        return false;
+    }
+
+    bool passed = dbHelper->executeSqlWithParams(
+        "INSERT INTO user (account, password, create_time) VALUES (?, ?, datetime('now', 'localtime'))",
+        {"self-test", "self-test"});
+    int userId = 0;
+    if (passed) {
+        SqliteHelper::CachedQuery query = dbHelper->executeQueryWithParams("SELECT id FROM user WHERE account = ?", {"self-test"});
+        if (query.next()) userId = query.value(0).toInt();
+        query.finish();
+    }
+    passed = report("创建测试用户", userId > 0);
+
+    if (passed) {
+        // 各项都要执行，不因前一项失败而跳过
+        passed = checkAddRecord(userId) & passed;
+        passed = checkAddRecords(userId) & passed;
+        passed = checkAddRecordInTransaction(userId) & passed;
+        passed = checkImportRecords(userId) & passed;
+        passed = checkBulkUpsert(userId) & passed;
+        passed = checkTrend(userId) & passed;
+    }
+
+    QSqlDatabase::removeDatabase(kReaderConnection);
+    dbHelper->closeDatabase();
+    removeDatabaseFiles(filePath);
+    qDebug() << (passed ? "自检全部通过" : "自检未通过");
+    return passed;
+}
+
+bool DbSelfTest::checkAddRecord(int userId) {
+    AccountRecord record(userId, -23.5, "餐饮", "自检单条");
+    record.setCreateTime("2024-03-15 12:30:00");
+    AccountManager accountManager;
+    int recordId = accountManager.addAccountRecord(record);
+    return report("单条记账（无外层事务）", recordId > 0 && readBack(recordId, -23.5, "餐饮"));
+}
+
+bool DbSelfTest::checkAddRecords(int userId) {
+    QList<AccountRecord> records;
+    for (int i = 0; i < 3; ++i) {
+        AccountRecord record(userId, 100.0 + i, "工资", "自检批量");
+        record.setCreateTime(QString("2024-03-%1 09:00:00").arg(16 + i));
+        records.append(record);
+    }
+    AccountManager accountManager;
+    QList<int> ids = accountManager.addAccountRecords(records);
+    bool ok = ids.size() == records.size();
+    for (int i = 0; ok && i < ids.size(); ++i) {
+        ok = readBack(ids.at(i), records.at(i).getAmount(), records.at(i).getType());
+    }
+    return report("批量记账（无外层事务）", ok);
+}
+
+bool DbSelfTest::checkAddRecordInTransaction(int userId) {
+    SqliteHelper* dbHelper = SqliteHelper::getInstance();
+    if (!dbHelper->beginTransaction()) {
+        return report("单条记账（并入外层事务）", false);
+    }
+    AccountRecord record(userId, -8.0, "交通", "自检事务");
+    record.setCreateTime("2024-03-20 18:00:00");
+    AccountManager accountManager;
+    int recordId = accountManager.addAccountRecord(record);
+    bool ok = recordId > 0 && dbHelper->commitTransaction();
+    if (!ok) {
+        dbHelper->rollbackTransaction();
+    }
+    return report("单条记账（并入外层事务）", ok && readBack(recordId, -8.0, "交通"));
+}
+
+bool DbSelfTest::checkImportRecords(int userId) {
+    // 超过 AccountManager 的导入阈值（1000 条）
+    QList<AccountRecord> records;
+    for (int i = 0; i < 1200; ++i) {
+        AccountRecord record(userId, (i % 2 == 0) ? -(1.25 + i) : 10.0 + i,
+                             (i % 3 == 0) ? "购物" : "餐饮", QString("自检导入%1").arg(i));
+        record.setCreateTime(QString("2024-04-%1 10:00:00").arg(1 + i % 28, 2, 10, QChar('0')));
+        records.append(record);
+    }
+    AccountManager accountManager;
+    QList<int> ids = accountManager.addAccountRecords(records);
+    bool ok = ids.size() == records.size();
+    for (int i : {0, 599, 1199}) {
+        ok = ok && readBack(ids.at(i), records.at(i).getAmount(), records.at(i).getType());
+    }
+
+    SqliteHelper* dbHelper = SqliteHelper::getInstance();
+    QStringList issues = dbHelper->checkDailyRollup();
+    if (!issues.isEmpty()) {
+        qDebug() << "导入后每日汇总不一致：" << issues;
+        ok = false;
+    }
+    if (dbHelper->hasFullTextIndex()) {
+        SqliteHelper::CachedQuery query = dbHelper->executeQueryWithParams(
+            "SELECT COUNT(*) FROM account_record_fts WHERE account_record_fts MATCH ?", {"\"自检导入1199\""});
+        ok = ok && query.next() && query.value(0).toInt() == 1;
+        query.finish();
+    }
+
+    // 触发器已恢复：导入之后的单条记账照常维护汇总
+    SqliteHelper::CachedQuery triggers = dbHelper->executeQueryWithParams(
+        "SELECT COUNT(*) FROM sqlite_master WHERE type = 'trigger' AND name IN (?, ?)",
+        {"trg_account_record_rollup_insert", "trg_account_record_fts_insert"});
+    ok = ok && triggers.next() && triggers.value(0).toInt() == (dbHelper->hasFullTextIndex() ? 2 : 1);
+    triggers.finish();
+    AccountRecord after(userId, -3.0, "餐饮", "自检导入后");
+    after.setCreateTime("2024-04-02 11:00:00");
+    ok = ok && accountManager.addAccountRecord(after) > 0 && dbHelper->checkDailyRollup().isEmpty();
+    return report("大批量记账（导入路径）", ok);
+}
+
+bool DbSelfTest::checkBulkUpsert(int userId) {
+    SqliteHelper* dbHelper = SqliteHelper::getInstance();
+    const QStringList columns = {"user_id", "category", "period", "limit_amount"};
+    QList<QVariantList> values = {{userId, userId}, {"餐饮", "交通"}, {1, 1}, {500.0, 200.0}};
+    SqliteHelper::BulkWriteResult inserted =
+        dbHelper->bulkUpsert("budget_rule", columns, values, {"user_id", "category", "period"});
+    values[3] = {600.0, 300.0};
+    SqliteHelper::BulkWriteResult updated =
+        dbHelper->bulkUpsert("budget_rule", columns, values, {"user_id", "category", "period"});
+    bool ok = inserted.success && updated.success && inserted.rowIds.size() == 2
+              && inserted.rowIds == updated.rowIds;
+
+    SqliteHelper::CachedQuery query = dbHelper->executeQueryWithParams(
+        "SELECT limit_amount FROM budget_rule WHERE id = ?", {ok ? updated.rowIds.first() : -1});
+    ok = ok && query.next() && qAbs(query.value(0).toDouble() - 600.0) < 0.005;
+    query.finish();
+
+    BudgetManager* budgetManager = BudgetManager::getInstance();
+    ok = ok && budgetManager->setBudget(userId, 50, 1000, 0) && budgetManager->setBudget(userId, 60, 0, 12000);
+    BudgetInfo info = budgetManager->getBudget(userId);
+    ok = ok && qAbs(info.daily - 60) < 0.005 && info.monthly == 0 && qAbs(info.yearly - 12000) < 0.005;
+    return report("批量插入或更新（预算规则）", ok);
+}
+
+bool DbSelfTest::checkTrend(int userId) {
+    // 2 月没有记录，3、4 月有前面各项写入的记录
+    const QDate firstDay(2024, 2, 1);
+    const QDate lastDay(2024, 4, 30);
+    TrendSeries series = StatisticsManager::getInstance()->getTrend(userId, firstDay, lastDay,
+                                                                    PeriodGranularity::Month, 0);
+    AccountManager accountManager;
+    QList<PeriodCategoryTotal> totals;
+    bool ok = series.isValid() && series.size() == 3
+              && accountManager.queryPeriodTotals(userId, firstDay, lastDay, PeriodGranularity::Month, totals);
+    for (int i = 0; ok && i < series.size(); ++i) {
+        const TrendPoint& point = series.at(i);
+        qint64 income = 0;
+        qint64 expense = 0;
+        for (const PeriodCategoryTotal& total : totals) {
+            if (total.periodStart != point.firstDay) continue;
+            income += total.incomeCents;
+            expense += total.expenseCents;
+        }
+        qint64 recordIncome = 0;
+        qint64 recordExpense = 0;
+        ok = point.firstDay == QDate(2024, 2 + i, 1)
+             && qRound64(point.income * 100) == income && qRound64(point.expense * 100) == expense
+             && sumRecords(userId, point.firstDay, point.lastDay, recordIncome, recordExpense)
+             && recordIncome == income && recordExpense == expense
+             && (i > 0 || (income == 0 && expense == 0));
+        if (!ok) {
+            qDebug() << "趋势合计不一致：" << point.label << point.income << point.expense
+                     << "分组合计" << income << expense << "明细合计" << recordIncome << recordExpense;
+        }
+    }
+    return report("多周期趋势（按月）", ok);
+}
+
+bool DbSelfTest::sumRecords(int userId, const QDate& firstDay, const QDate& lastDay,
+                            qint64& incomeCents, qint64& expenseCents) {
+    // 逐条四舍五入到分后求和，与 daily_rollup 的计算方式相同
+    QSqlDatabase db = readerConnection();
+    if (!db.isOpen()) return false;
+    QSqlQuery query(db);
+    query.prepare("SELECT "
+                  "COALESCE(SUM(CASE WHEN amount >= 0 THEN CAST(round(amount * 100) AS INTEGER) END), 0), "
+                  "COALESCE(SUM(CASE WHEN amount < 0 THEN -CAST(round(amount * 100) AS INTEGER) END), 0) "
+                  "FROM account_record WHERE user_id = ? AND is_deleted = 0 "
+                  "AND substr(create_time, 1, 10) BETWEEN ? AND ?");
+    query.addBindValue(userId);
+    query.addBindValue(firstDay.toString("yyyy-MM-dd"));
+    query.addBindValue(lastDay.toString("yyyy-MM-dd"));
+    if (!query.exec() || !query.next()) {
+        qDebug() << "按明细计算合计失败：" << query.lastError().text();
+        return false;
+    }
+    incomeCents = query.value(0).toLongLong();
+    expenseCents = query.value(1).toLongLong();
+    return true;
+}
+
+bool DbSelfTest::readBack(int recordId, double amount, const QString& category) {
+    QSqlDatabase db = readerConnection();
+    if (!db.isOpen()) return false;
+    QSqlQuery query(db);
+    query.prepare("SELECT amount, category FROM account_record WHERE id = ? AND is_deleted = 0");
+    query.addBindValue(recordId);
+    bool found = query.exec() && query.next();
+    bool ok = found && qAbs(query.value(0).toDouble() - amount) < 0.005 && query.value(1).toString() == category;
+    if (!ok) {
+        qDebug() << "读回记录不一致：ID=" << recordId << (found ? "" : query.lastError().text());
+    }
+    return ok;
+}
+
+bool DbSelfTest::report(const QString& name, bool passed) {
+    qDebug().noquote() << (passed ? "[通过]" : "[失败]") << name;
+    return passed;
+}
@@ -0,0 +1,39 @@
+#ifndef DB_SELF_TEST_H
+#define DB_SELF_TEST_H
+
+#include <QString>
+#include <QDate>
+
+/**
+ * @brief 数据库自检 - 在临时库中走一遍记账写入路径，写入后从另一个连接读回核对
+ *        （通过 --self-test 启动参数运行，不会触碰正式数据库）
+ */
+class DbSelfTest
+{
+public:
+    // 运行全部检查，逐项输出结果；全部通过返回 true
+    static bool run();
+
+private:
+    // 不在事务中单条记账，提交后能读回
+    static bool checkAddRecord(int userId);
+    // 不在事务中批量记账，返回的行 ID 与读回的记录一一对应
+    static bool checkAddRecords(int userId);
+    // 调用方已开启事务时并入该事务，提交后能读回
+    static bool checkAddRecordInTransaction(int userId);
+    // 大批量记账走导入路径：行 ID 连续且可读回，每日汇总、全文索引与触发器都保持一致
+    static bool checkImportRecords(int userId);
+    // 批量插入或更新：冲突行返回原行 ID，setBudget 写入后读回的限额一致
+    static bool checkBulkUpsert(int userId);
+    // 多周期趋势：周期连续（无记录的月份为 0），各周期合计与 queryPeriodTotals 及记录明细逐分一致
+    static bool checkTrend(int userId);
+
+    // 通过独立连接按 ID 读回已提交的记录，核对金额与分类
+    static bool readBack(int recordId, double amount, const QString& category);
+    // 通过独立连接按记录明细计算 [firstDay, lastDay] 内的收入、支出合计（分）
+    static bool sumRecords(int userId, const QDate& firstDay, const QDate& lastDay,
+                           qint64& incomeCents, qint64& expenseCents);
+    static bool report(const QString& name, bool passed);
+};
+
+#endif // DB_SELF_TEST_H
@@ -5,6 +5,11 @@
 #include "AccountBookRecordWidget.h"
 #include "AccountBookMainWidget.h"
 #include "sqlite_helper.h"
+#include "db_maintenance.h"
+#include "db_benchmark.h"
+#include "db_self_test.h"
+#include "category_registry.h"
+#include "range_sum_index.h"
 #include "server_main.h"
 #include "user_manager.h"
 #include <QApplication>
@@ -25,11 +30,45 @@ int main(int argc, char *argv[])
     }
     QString dbPath = dbDir + "/account_book.db";
     
+    // --benchmark [行数]：在临时库中运行账单行解码、时间解析、月度统计与趋势微基准后退出，不打开正式数据库
+    int benchmarkIndex = a.arguments().indexOf("--benchmark");
+    if (benchmarkIndex >= 0) {
+        int rowCount = a.arguments().value(benchmarkIndex + 1).toInt();
+        DbBenchmark::runRecordDecode(rowCount > 0 ? rowCount : 1000000);
+        DbBenchmark::runTimestampParse(rowCount > 0 ? rowCount : 1000000);
+        DbBenchmark::runMonthlyStat();
+        DbBenchmark::runTrend();
+        return 0;
+    }
+
+    // --self-test：在临时库中检查记账写入能提交并读回后退出，不打开正式数据库；未通过时返回 1
+    if (a.arguments().contains("--self-test")) {
+        return DbSelfTest::run() ? 0 : 1;
+    }
+
     SqliteHelper* dbHelper = SqliteHelper::getInstance();
-    if (!dbHelper->openDatabase(dbPath)) {
+    // --explain-queries：启动时检查热点查询的执行计划
+    if (a.arguments().contains("--explain-queries")) {
+        dbHelper->setQueryPlanDiagnostics(true);
+    }
+    // 客户端数据库：界面线程与后台同步线程并发访问，使用交互式配置档
+    if (!dbHelper->openDatabase(dbPath, "interactive-client")) {
         qCritical() << "数据库初始化失败，程序即将退出";
         return -1;
     }
+    // --rebuild-rollup：按全表扫描重建每日汇总；--check-rollup：对比每日汇总与全表扫描，不一致时输出差异
+    if (a.arguments().contains("--rebuild-rollup")) {
+        dbHelper->rebuildDailyRollup();
+    }
+    if (a.arguments().contains("--check-rollup")) {
+        dbHelper->checkDailyRollup();
+    }
+    // 空闲时在后台做增量空间回收、统计信息更新和检查点
+    DbMaintenance::getInstance()->start();
+    // 预设分类之外，登记数据库中已有的分类
+    CategoryRegistry::getInstance()->loadFromDatabase();
+    // 读取上次退出时保存的区间合计索引，各用户首次查询时校验后采用
+    RangeSumIndex::getInstance()->load();
 
     // 配置邮件发送服务（QQ邮箱）
     // TODO: 请在这里填写你的QQ邮箱和授权码
@@ -60,5 +99,7 @@ int main(int argc, char *argv[])
 
     // 登录窗口显示
     loginWidget.show();
-    return a.exec();
+    int ret = a.exec();
+    RangeSumIndex::getInstance()->save();
+    return ret;
 }
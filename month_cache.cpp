@@ -0,0 +1,244 @@
+#include "month_cache.h"
+#include "sqlite_helper.h"
+#include "timestamp_parser.h"
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+
+MonthCache* MonthCache::m_instance = nullptr;
+QMutex MonthCache::m_instanceMutex;
+
+MonthCache* MonthCache::getInstance() {
+    if (m_instance == nullptr) {
+        m_instanceMutex.lock();
+        if (m_instance == nullptr) {
+            m_instance = new MonthCache();
+        }
+        m_instanceMutex.unlock();
+    }
+    return m_instance;
+}
+
+bool MonthCache::isNewer(const AccountRecord& a, const AccountRecord& b) {
+    if (a.getCreateTime() != b.getCreateTime()) {
+        return a.getCreateTime() > b.getCreateTime();
+    }
+    return a.getId() > b.getId();
+}
+
+// ============ 读取 ============
+bool MonthCache::lookup(int userId, int year, int month, QList<AccountRecord>& records) {
+    qint64 current = SqliteHelper::getInstance()->recordGeneration();
+    QMutexLocker locker(&m_mutex);
+    syncGeneration(current, current);
+
+    quint64 key = makeKey(userId, year, month);
+    auto it = m_slices.constFind(key);
+    if (it == m_slices.constEnd()) {
+        ++m_misses;
+        return false;
+    }
+    ++m_hits;
+    touch(key);
+    // QList 隐式共享，这里不复制记录
+    records = it.value().records;
+    return true;
+}
+
+bool MonthCache::lookupColumns(int userId, int year, int month, RecordColumns& columns) {
+    qint64 current = SqliteHelper::getInstance()->recordGeneration();
+    QMutexLocker locker(&m_mutex);
+    syncGeneration(current, current);
+
+    quint64 key = makeKey(userId, year, month);
+    auto it = m_slices.find(key);
+    if (it == m_slices.end()) {
+        ++m_misses;
+        return false;
+    }
+    ++m_hits;
+    touch(key);
+    Slice& slice = it.value();
+    if (!slice.hasColumns) {
+        slice.columns = RecordColumns::fromRecords(slice.records);
+        slice.hasColumns = true;
+        slice.bytes += slice.columns.bytes();
+        m_bytes += slice.columns.bytes();
+    }
+    columns = slice.columns;
+    trim();
+    return true;
+}
+
+void MonthCache::insert(int userId, int year, int month, const QList<AccountRecord>& records, qint64 generation) {
+    qint64 current = SqliteHelper::getInstance()->recordGeneration();
+    // 读取期间发生过写入，读到的可能已过期
+    if (generation != current) return;
+
+    QMutexLocker locker(&m_mutex);
+    syncGeneration(generation, current);
+
+    quint64 key = makeKey(userId, year, month);
+    Slice& slice = m_slices[key];
+    m_bytes -= slice.bytes;
+    slice.records = records;
+    slice.columns = RecordColumns();
+    slice.hasColumns = false;
+    slice.bytes = 0;
+    for (const AccountRecord& record : records) {
+        slice.bytes += recordBytes(record);
+    }
+    m_bytes += slice.bytes;
+    touch(key);
+    trim();
+}
+
+// ============ 写穿透 ============
+void MonthCache::upsertRecords(const QList<AccountRecord>& records, qint64 generationBefore,
+                               qint64 generationAfter) {
+    QMutexLocker locker(&m_mutex);
+    if (m_generation != generationBefore) {
+        syncGeneration(generationBefore, generationAfter);
+        return;
+    }
+    m_generation = generationAfter;
+    if (m_slices.isEmpty()) return;
+
+    // 先移除旧版本（修改可能改变记录所属的月份）
+    QSet<int> ids;
+    for (const AccountRecord& record : records) {
+        ids.insert(record.getId());
+    }
+    for (auto it = m_slices.begin(); it != m_slices.end(); ++it) {
+        QList<AccountRecord>& list = it.value().records;
+        for (int i = list.size() - 1; i >= 0; --i) {
+            if (ids.contains(list.at(i).getId())) {
+                dropColumns(it.value());
+                it.value().bytes -= recordBytes(list.at(i));
+                m_bytes -= recordBytes(list.at(i));
+                list.removeAt(i);
+            }
+        }
+    }
+
+    // 再把未删除的新版本插入所属月份；月份未缓存时不处理，下次读取会从数据库加载
+    for (const AccountRecord& record : records) {
+        quint64 key = 0;
+        if (record.getIsDeleted() || !recordKey(record, key)) continue;
+        auto it = m_slices.find(key);
+        if (it == m_slices.end()) continue;
+        dropColumns(it.value());
+        QList<AccountRecord>& list = it.value().records;
+        list.insert(std::lower_bound(list.begin(), list.end(), record, &MonthCache::isNewer), record);
+        it.value().bytes += recordBytes(record);
+        m_bytes += recordBytes(record);
+    }
+    trim();
+}
+
+void MonthCache::removeRecords(const QList<int>& recordIds, qint64 generationBefore,
+                               qint64 generationAfter) {
+    QMutexLocker locker(&m_mutex);
+    if (m_generation != generationBefore) {
+        syncGeneration(generationBefore, generationAfter);
+        return;
+    }
+    m_generation = generationAfter;
+
+    QSet<int> ids;
+    for (int id : recordIds) {
+        ids.insert(id);
+    }
+    for (auto it = m_slices.begin(); it != m_slices.end(); ++it) {
+        QList<AccountRecord>& list = it.value().records;
+        for (int i = list.size() - 1; i >= 0; --i) {
+            if (ids.contains(list.at(i).getId())) {
+                dropColumns(it.value());
+                it.value().bytes -= recordBytes(list.at(i));
+                m_bytes -= recordBytes(list.at(i));
+                list.removeAt(i);
+            }
+        }
+    }
+}
+
+// ============ 容量与统计 ============
+void MonthCache::clear() {
+    QMutexLocker locker(&m_mutex);
+    clearLocked();
+}
+
+void MonthCache::setCapacity(qint64 bytes) {
+    QMutexLocker locker(&m_mutex);
+    m_capacityBytes = qMax<qint64>(0, bytes);
+    trim();
+}
+
+MonthCache::Stats MonthCache::stats() const {
+    QMutexLocker locker(&m_mutex);
+    Stats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    stats.months = m_slices.size();
+    stats.bytes = m_bytes;
+    stats.capacityBytes = m_capacityBytes;
+    return stats;
+}
+
+// ============ 私有方法 ============
+quint64 MonthCache::makeKey(int userId, int year, int month) {
+    return (quint64(quint32(userId)) << 32) | quint32(year * 100 + month);
+}
+
+bool MonthCache::recordKey(const AccountRecord& record, quint64& key) {
+    bool ok = false;
+    qint64 secs = record.getBillTimestamp(&ok);
+    if (!ok) return false;
+    QDate date = TimestampParser::toDate(secs);
+    key = makeKey(record.getUserId(), date.year(), date.month());
+    return true;
+}
+
+qint64 MonthCache::recordBytes(const AccountRecord& record) {
+    qint64 chars = record.getType().size() + record.getRemark().size() + record.getVoucherPath().size()
+                   + record.getDeleteTime().size() + record.getCreateTime().size() + record.getModifyTime().size();
+    return qint64(sizeof(AccountRecord)) + chars * qint64(sizeof(QChar));
+}
+
+void MonthCache::syncGeneration(qint64 expected, qint64 current) {
+    if (m_generation != expected && !m_slices.isEmpty()) {
+        qDebug() << "账单数据已被其他路径修改，清空月度缓存";
+        clearLocked();
+    }
+    m_generation = current;
+}
+
+void MonthCache::touch(quint64 key) {
+    m_lru.removeOne(key);
+    m_lru.append(key);
+}
+
+void MonthCache::dropColumns(Slice& slice) {
+    if (!slice.hasColumns) return;
+    slice.bytes -= slice.columns.bytes();
+    m_bytes -= slice.columns.bytes();
+    slice.columns = RecordColumns();
+    slice.hasColumns = false;
+}
+
+void MonthCache::trim() {
+    // 至少保留最近使用的一个月，即使它单独超过上限
+    while (m_bytes > m_capacityBytes && m_lru.size() > 1) {
+        quint64 key = m_lru.takeFirst();
+        m_bytes -= m_slices.value(key).bytes;
+        m_slices.remove(key);
+        ++m_evictions;
+    }
+}
+
+void MonthCache::clearLocked() {
+    m_slices.clear();
+    m_lru.clear();
+    m_bytes = 0;
+}
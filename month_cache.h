@@ -0,0 +1,94 @@
+#ifndef MONTH_CACHE_H
+#define MONTH_CACHE_H
+
+#include "account_record.h"
+#include "record_columns.h"
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+/**
+ * @brief 月度账单缓存 - 单例，按 (用户, 年, 月) 缓存已解码的未删除记录，
+ *        记录按 (create_time, id) 倒序排列，与键集分页的顺序一致。
+ *        AccountManager 写入成功后就地更新缓存；其他路径的写入通过
+ *        SqliteHelper 的账单写入计数发现，发现后整体清空。超出内存上限时淘汰最久未使用的月份。
+ *        统计用的列式快照在首次需要时由整月记录生成，随记录一起缓存，记录变化时丢弃。
+ */
+class MonthCache
+{
+public:
+    static MonthCache* getInstance();
+
+    struct Stats {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 evictions = 0;
+        int months = 0;             // 当前缓存的月份数
+        qint64 bytes = 0;           // 当前占用（估算）
+        qint64 capacityBytes = 0;   // 内存上限
+        double hitRate() const { return hits + misses > 0 ? double(hits) / (hits + misses) : 0; }
+    };
+
+    // 命中时把整月记录写入 records 并返回 true
+    bool lookup(int userId, int year, int month, QList<AccountRecord>& records);
+    // 命中时返回整月记录的列式快照（首次访问时生成）
+    bool lookupColumns(int userId, int year, int month, RecordColumns& columns);
+    // 放入从数据库读出的整月记录；generation 为开始读取前的写入计数，读取期间有写入则丢弃
+    void insert(int userId, int year, int month, const QList<AccountRecord>& records, qint64 generation);
+
+    // ============ 写穿透（写入成功后调用） ============
+    // generationBefore / generationAfter 为本线程写入前后的账单写入计数（见 SqliteHelper::ownRecordGeneration），
+    // 缓存停在写入前的计数时才增量更新并推进到写入后，否则整体作废
+    // 新增或修改：先按 id 移除旧版本，未删除且所在月份已缓存时按顺序插入
+    void upsertRecords(const QList<AccountRecord>& records, qint64 generationBefore, qint64 generationAfter);
+    // 删除或移入回收站
+    void removeRecords(const QList<int>& recordIds, qint64 generationBefore, qint64 generationAfter);
+
+    // 清空全部缓存（恢复备份等整体替换数据后调用）
+    void clear();
+    // 内存上限（字节），默认 16 MB
+    void setCapacity(qint64 bytes);
+    Stats stats() const;
+
+    // 缓存内的排序：a 排在 b 之前时返回 true（create_time 倒序，同一时间按 id 倒序）
+    static bool isNewer(const AccountRecord& a, const AccountRecord& b);
+
+private:
+    MonthCache() = default;
+    static MonthCache* m_instance;
+    static QMutex m_instanceMutex;
+
+    struct Slice {
+        QList<AccountRecord> records;
+        RecordColumns columns;
+        bool hasColumns = false;
+        qint64 bytes = 0;           // 记录与列式快照合计
+    };
+
+    static quint64 makeKey(int userId, int year, int month);
+    // 按记账时间的年月定位所属月份，时间无法解析时返回 false
+    static bool recordKey(const AccountRecord& record, quint64& key);
+    static qint64 recordBytes(const AccountRecord& record);
+
+    // 以下方法要求已持有 m_mutex
+    // 与当前写入计数比对，不一致说明有未经缓存的写入，清空后重新对齐
+    void syncGeneration(qint64 expected, qint64 current);
+    void touch(quint64 key);
+    // 记录变化后列式快照失效
+    void dropColumns(Slice& slice);
+    void trim();
+    void clearLocked();
+
+    mutable QMutex m_mutex;
+    QHash<quint64, Slice> m_slices;
+    QList<quint64> m_lru;           // 最久未使用的在前
+    qint64 m_bytes = 0;
+    qint64 m_capacityBytes = 16LL * 1024 * 1024;
+    qint64 m_generation = -1;       // 缓存内容对应的写入计数
+    qint64 m_hits = 0;
+    qint64 m_misses = 0;
+    qint64 m_evictions = 0;
+};
+
+#endif // MONTH_CACHE_H
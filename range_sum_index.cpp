@@ -0,0 +1,340 @@
+#include "range_sum_index.h"
+#include "sqlite_helper.h"
+#include "timestamp_parser.h"
+#include <QSaveFile>
+#include <QDataStream>
+#include <QFile>
+#include <QSet>
+#include <QDebug>
+
+RangeSumIndex* RangeSumIndex::m_instance = nullptr;
+QMutex RangeSumIndex::m_instanceMutex;
+
+namespace {
+// 旁路文件格式
+const quint32 kFileMagic = 0x52534958;   // "RSIX"
+const qint32 kFileVersion = 1;
+// 建立或扩展范围时在两端多留的天数，新记账一般落在已有范围内，不必扩展
+const int kSlackDays = 366;
+}
+
+RangeSumIndex* RangeSumIndex::getInstance() {
+    if (m_instance == nullptr) {
+        m_instanceMutex.lock();
+        if (m_instance == nullptr) {
+            m_instance = new RangeSumIndex();
+        }
+        m_instanceMutex.unlock();
+    }
+    return m_instance;
+}
+
+// ============ 查询 ============
+bool RangeSumIndex::rangeSum(int userId, const QDate& firstDay, const QDate& lastDay, RangeSum& sum) {
+    sum = RangeSum();
+    QMutexLocker locker(&m_mutex);
+    if (!ensureUser(userId)) {
+        return false;
+    }
+    if (!firstDay.isValid() || !lastDay.isValid() || firstDay > lastDay) {
+        return true;
+    }
+
+    const UserIndex& index = m_users[userId];
+    qint64 first = qMax<qint64>(index.origin.daysTo(firstDay), 0);
+    qint64 last = qMin<qint64>(index.origin.daysTo(lastDay), index.days() - 1);
+    if (first > last) {
+        return true;
+    }
+    RangeSum upper = index.prefix(int(last));
+    RangeSum lower = index.prefix(int(first) - 1);
+    sum.incomeCents = upper.incomeCents - lower.incomeCents;
+    sum.expenseCents = upper.expenseCents - lower.expenseCents;
+    return true;
+}
+
+bool RangeSumIndex::isEmpty() const {
+    QMutexLocker locker(&m_mutex);
+    return m_users.isEmpty();
+}
+
+// ============ 写入后刷新 ============
+void RangeSumIndex::refreshDays(const QList<QPair<int, QDate>>& days, qint64 generationBefore,
+                                qint64 generationAfter) {
+    QMutexLocker locker(&m_mutex);
+    if (m_generation != generationBefore) {
+        syncGeneration(generationBefore, generationAfter);
+        return;
+    }
+    m_generation = generationAfter;
+    if (m_users.isEmpty()) return;
+
+    // 同一用户的日期放在一起处理，每个用户读一次版本号
+    QHash<int, QSet<QDate>> byUser;
+    for (const auto& day : days) {
+        if (day.second.isValid() && m_users.contains(day.first)) {
+            byUser[day.first].insert(day.second);
+        }
+    }
+
+    SqliteHelper* helper = SqliteHelper::getInstance();
+    QString sql = "SELECT COALESCE(SUM(CASE WHEN type = 1 THEN sum_cents END), 0), "
+                  "COALESCE(SUM(CASE WHEN type = 0 THEN -sum_cents END), 0) "
+                  "FROM daily_rollup WHERE user_id = ? AND day = ?";
+    for (auto it = byUser.begin(); it != byUser.end(); ++it) {
+        UserIndex& index = m_users[it.key()];
+        // 先读版本号再读合计：期间若有其他写入，保存的版本号只会偏旧，下次启动时按过期处理
+        index.revision = queryRevision(it.key());
+        for (const QDate& day : it.value()) {
+            SqliteHelper::CachedQuery query = helper->executeQueryWithParams(sql, {it.key(), day.toString("yyyy-MM-dd")});
+            bool found = query.next();
+            qint64 income = found ? query.value(0).toLongLong() : 0;
+            qint64 expense = found ? query.value(1).toLongLong() : 0;
+            // 成功与失败都先结束语句再处理结果
+            query.finish();
+            if (!found) {
+                // 读取失败时索引已不可信，下次查询重新构建
+                m_users.remove(it.key());
+                break;
+            }
+
+            ensureCovers(index, day);
+            int pos = int(index.origin.daysTo(day));
+            index.add(pos, income - index.income.at(pos), expense - index.expense.at(pos));
+        }
+    }
+}
+
+void RangeSumIndex::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_users.clear();
+    m_persisted.clear();
+}
+
+// ============ 旁路文件 ============
+QString RangeSumIndex::defaultFilePath() {
+    QString dbPath = SqliteHelper::getInstance()->databasePath();
+    return dbPath.isEmpty() ? QString() : dbPath + ".rangesum";
+}
+
+bool RangeSumIndex::save(const QString& filePath) {
+    if (filePath.isEmpty()) return false;
+
+    qint64 current = SqliteHelper::getInstance()->recordGeneration();
+    QMutexLocker locker(&m_mutex);
+    // 有未经索引的写入时内存中的内容已过期，只保存尚未采用的旁路数据
+    syncGeneration(current, current);
+    QHash<int, UserIndex> users = m_persisted;
+    for (auto it = m_users.constBegin(); it != m_users.constEnd(); ++it) {
+        users.insert(it.key(), it.value());
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "区间合计索引保存失败：" << file.errorString();
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kFileMagic << kFileVersion << qint32(users.size());
+    for (auto it = users.constBegin(); it != users.constEnd(); ++it) {
+        const UserIndex& index = it.value();
+        out << qint32(it.key()) << index.revision << index.origin.toJulianDay() << qint32(index.days());
+        for (qint64 value : index.income) out << value;
+        for (qint64 value : index.expense) out << value;
+    }
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        qDebug() << "区间合计索引保存失败：" << file.errorString();
+        return false;
+    }
+    qDebug() << "区间合计索引已保存，用户数：" << users.size();
+    return true;
+}
+
+bool RangeSumIndex::load(const QString& filePath) {
+    if (filePath.isEmpty() || !QFile::exists(filePath)) return false;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "区间合计索引读取失败：" << file.errorString();
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != kFileMagic || version != kFileVersion || count < 0) {
+        qDebug() << "区间合计索引文件格式不符，忽略：" << filePath;
+        return false;
+    }
+
+    QHash<int, UserIndex> users;
+    for (int i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        qint32 userId = 0;
+        qint64 julianDay = 0;
+        qint32 days = 0;
+        UserIndex index;
+        in >> userId >> index.revision >> julianDay >> days;
+        if (days < 0 || days > 1000000) break;
+        index.origin = QDate::fromJulianDay(julianDay);
+        index.income.resize(days);
+        index.expense.resize(days);
+        for (int d = 0; d < days; ++d) in >> index.income[d];
+        for (int d = 0; d < days; ++d) in >> index.expense[d];
+        users.insert(userId, index);
+    }
+    if (in.status() != QDataStream::Ok || users.size() != count) {
+        qDebug() << "区间合计索引文件已损坏，忽略：" << filePath;
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_persisted = users;
+    qDebug() << "区间合计索引已读取，用户数：" << users.size();
+    return true;
+}
+
+// ============ 树状数组 ============
+void RangeSumIndex::UserIndex::buildTrees() {
+    int n = days();
+    incomeTree = QList<qint64>(n + 1, 0);
+    expenseTree = QList<qint64>(n + 1, 0);
+    // 线性构建：每个节点把自己的和加到父节点
+    for (int i = 1; i <= n; ++i) {
+        incomeTree[i] += income.at(i - 1);
+        expenseTree[i] += expense.at(i - 1);
+        int parent = i + (i & -i);
+        if (parent <= n) {
+            incomeTree[parent] += incomeTree[i];
+            expenseTree[parent] += expenseTree[i];
+        }
+    }
+}
+
+void RangeSumIndex::UserIndex::add(int index, qint64 incomeDelta, qint64 expenseDelta) {
+    if (incomeDelta == 0 && expenseDelta == 0) return;
+    income[index] += incomeDelta;
+    expense[index] += expenseDelta;
+    for (int i = index + 1, n = days(); i <= n; i += i & -i) {
+        incomeTree[i] += incomeDelta;
+        expenseTree[i] += expenseDelta;
+    }
+}
+
+RangeSumIndex::RangeSum RangeSumIndex::UserIndex::prefix(int index) const {
+    RangeSum sum;
+    for (int i = index + 1; i > 0; i -= i & -i) {
+        sum.incomeCents += incomeTree.at(i);
+        sum.expenseCents += expenseTree.at(i);
+    }
+    return sum;
+}
+
+// ============ 私有方法 ============
+bool RangeSumIndex::ensureUser(int userId) {
+    qint64 current = SqliteHelper::getInstance()->recordGeneration();
+    syncGeneration(current, current);
+    if (m_users.contains(userId)) {
+        return true;
+    }
+
+    UserIndex index;
+    auto persisted = m_persisted.find(userId);
+    if (persisted != m_persisted.end()) {
+        // 旁路文件中的版本号与数据库一致时直接采用，只需线性重建树
+        UserIndex saved = persisted.value();
+        m_persisted.erase(persisted);
+        if (saved.revision >= 0 && saved.revision == queryRevision(userId)) {
+            saved.buildTrees();
+            m_users.insert(userId, saved);
+            return true;
+        }
+    }
+    if (!buildFromRollup(userId, index)) {
+        return false;
+    }
+    m_users.insert(userId, index);
+    return true;
+}
+
+bool RangeSumIndex::buildFromRollup(int userId, UserIndex& index) {
+    index.revision = queryRevision(userId);
+
+    // 沿 daily_rollup 主键按日期顺序读取，每天一行
+    QString sql = "SELECT day, COALESCE(SUM(CASE WHEN type = 1 THEN sum_cents END), 0), "
+                  "COALESCE(SUM(CASE WHEN type = 0 THEN -sum_cents END), 0) "
+                  "FROM daily_rollup WHERE user_id = ? GROUP BY day ORDER BY day";
+    SqliteHelper::CachedQuery query = SqliteHelper::getInstance()->executeQueryWithParams(sql, {userId});
+    if (!query.isActive()) {
+        query.finish();
+        return false;
+    }
+    QList<QDate> dates;
+    QList<qint64> incomes;
+    QList<qint64> expenses;
+    while (query.next()) {
+        bool ok = false;
+        qint64 secs = TimestampParser::parse(query.value(0).toString(), &ok);
+        if (!ok) continue;   // create_time 不是日期格式的记录不参与按日期的合计
+        dates.append(TimestampParser::toDate(secs));
+        incomes.append(query.value(1).toLongLong());
+        expenses.append(query.value(2).toLongLong());
+    }
+    query.finish();
+
+    // 范围覆盖全部记录与今天，两端留出余量
+    QDate today = QDate::currentDate();
+    QDate first = dates.isEmpty() ? today : qMin(dates.first(), today);
+    QDate last = dates.isEmpty() ? today : qMax(dates.last(), today);
+    index.origin = first.addDays(-kSlackDays);
+    int days = int(index.origin.daysTo(last.addDays(kSlackDays))) + 1;
+    index.income = QList<qint64>(days, 0);
+    index.expense = QList<qint64>(days, 0);
+    for (int i = 0; i < dates.size(); ++i) {
+        int pos = int(index.origin.daysTo(dates.at(i)));
+        index.income[pos] = incomes.at(i);
+        index.expense[pos] = expenses.at(i);
+    }
+    index.buildTrees();
+    return true;
+}
+
+void RangeSumIndex::ensureCovers(UserIndex& index, const QDate& day) {
+    qint64 pos = index.origin.daysTo(day);
+    if (pos >= 0 && pos < index.days()) return;
+
+    if (pos < 0) {
+        QDate origin = day.addDays(-kSlackDays);
+        int extra = int(origin.daysTo(index.origin));
+        index.income = QList<qint64>(extra, 0) + index.income;
+        index.expense = QList<qint64>(extra, 0) + index.expense;
+        index.origin = origin;
+    } else {
+        int extra = int(pos - index.days() + 1 + kSlackDays);
+        index.income += QList<qint64>(extra, 0);
+        index.expense += QList<qint64>(extra, 0);
+    }
+    index.buildTrees();
+}
+
+void RangeSumIndex::syncGeneration(qint64 expected, qint64 current) {
+    if (m_generation != expected && !m_users.isEmpty()) {
+        qDebug() << "账单数据已被其他路径修改，清空区间合计索引";
+        m_users.clear();
+    }
+    m_generation = current;
+}
+
+qint64 RangeSumIndex::queryRevision(int userId) {
+    SqliteHelper::CachedQuery query = SqliteHelper::getInstance()->executeQueryWithParams(
+        "SELECT revision FROM rollup_revision WHERE user_id = ?", {userId});
+    if (!query.isActive()) {
+        query.finish();
+        return -1;
+    }
+    qint64 revision = query.next() ? query.value(0).toLongLong() : 0;
+    query.finish();
+    return revision;
+}
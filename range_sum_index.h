@@ -0,0 +1,85 @@
+#ifndef RANGE_SUM_INDEX_H
+#define RANGE_SUM_INDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QDate>
+#include <QMutex>
+#include <QString>
+
+/**
+ * @brief 按日期范围的收支合计索引 - 单例，每个用户一组按天分桶的树状数组（Fenwick 树），
+ *        收入、支出各一棵，任意 [起始日, 结束日] 的合计为 O(log n)。
+ *        用户首次查询时由 daily_rollup 构建；AccountManager 写入后按天从 daily_rollup 刷新，
+ *        每天 O(log n)。其他路径的写入通过 SqliteHelper 的账单写入计数发现，发现后整体清空。
+ *        可保存到数据库旁的文件，下次启动时 rollup_revision 未变化的用户直接恢复，不再查询汇总表。
+ */
+class RangeSumIndex
+{
+public:
+    static RangeSumIndex* getInstance();
+
+    // 范围合计（单位：分，支出为正数）
+    struct RangeSum {
+        qint64 incomeCents = 0;
+        qint64 expenseCents = 0;
+    };
+
+    // [firstDay, lastDay] 内未删除记录的合计；构建失败返回 false
+    bool rangeSum(int userId, const QDate& firstDay, const QDate& lastDay, RangeSum& sum);
+    // 尚未为任何用户建立索引（此时写入无需刷新）
+    bool isEmpty() const;
+    // 写入成功后调用：按 daily_rollup 重新读取这些 (用户, 日期) 的合计并更新树；
+    // generationBefore / generationAfter 为本线程写入前后的账单写入计数，索引停在写入前时才刷新
+    void refreshDays(const QList<QPair<int, QDate>>& days, qint64 generationBefore, qint64 generationAfter);
+    // 清空全部索引（恢复备份等整体替换数据后调用）
+    void clear();
+
+    // ============ 旁路文件 ============
+    // 数据库文件旁的默认路径（<数据库路径>.rangesum），数据库未打开时为空
+    static QString defaultFilePath();
+    // 保存当前已建立的索引；写入临时文件后整体替换，中途失败不破坏旧文件
+    bool save(const QString& filePath = defaultFilePath());
+    // 读取旁路文件，用户首次查询时与数据库的 rollup_revision 比对后再采用
+    bool load(const QString& filePath = defaultFilePath());
+
+private:
+    RangeSumIndex() = default;
+    static RangeSumIndex* m_instance;
+    static QMutex m_instanceMutex;
+
+    struct UserIndex {
+        QDate origin;                   // 下标 0 对应的日期
+        QList<qint64> income;           // 每天的合计
+        QList<qint64> expense;
+        QList<qint64> incomeTree;       // 树状数组，下标从 1 开始
+        QList<qint64> expenseTree;
+        qint64 revision = -1;           // 对应的 rollup_revision
+
+        int days() const { return income.size(); }
+        // 按每天的合计线性构建两棵树
+        void buildTrees();
+        void add(int index, qint64 incomeDelta, qint64 expenseDelta);
+        // 下标 [0, index] 的前缀和，index < 0 时为 0
+        RangeSum prefix(int index) const;
+    };
+
+    // 以下方法要求已持有 m_mutex
+    // 从旁路文件或 daily_rollup 建立用户索引
+    bool ensureUser(int userId);
+    bool buildFromRollup(int userId, UserIndex& index);
+    // 使 day 落在索引范围内，必要时扩展范围并重建树
+    void ensureCovers(UserIndex& index, const QDate& day);
+    void syncGeneration(qint64 expected, qint64 current);
+
+    // 用户的 rollup_revision，没有记录时为 0，查询失败时为 -1
+    static qint64 queryRevision(int userId);
+
+    mutable QMutex m_mutex;
+    QHash<int, UserIndex> m_users;
+    QHash<int, UserIndex> m_persisted;  // 旁路文件中尚未采用的索引
+    qint64 m_generation = -1;           // 索引内容对应的写入计数
+};
+
+#endif // RANGE_SUM_INDEX_H
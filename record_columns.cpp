@@ -0,0 +1,131 @@
+#include "record_columns.h"
+#include "category_registry.h"
+#include "timestamp_parser.h"
+
+// ============ 构建 ============
+RecordColumns RecordColumns::fromRecords(const QList<AccountRecord>& records) {
+    RecordColumns columns;
+    columns.reserve(records.size());
+    QHash<QString, int> categoryIndex;
+    for (const AccountRecord& record : records) {
+        bool timestampOk = false;
+        qint64 timestamp = record.getBillTimestamp(&timestampOk);
+        columns.append(timestamp, timestampOk, record.getAmount(),
+                       record.getType(), record.getIsDeleted() != 0, categoryIndex);
+    }
+    return columns;
+}
+
+void RecordColumns::reserve(int count) {
+    m_timestamps.reserve(count);
+    m_amountCents.reserve(count);
+    m_categoryIds.reserve(count);
+    m_flags.reserve(count);
+}
+
+void RecordColumns::append(qint64 timestamp, bool timestampOk, double amount, const QString& category,
+                           bool isDeleted, QHash<QString, int>& categoryIndex) {
+    // 同一快照内的分类名先查本地表，每个分类只访问一次注册表
+    auto it = categoryIndex.constFind(category);
+    int categoryId;
+    if (it != categoryIndex.constEnd()) {
+        categoryId = it.value();
+    } else {
+        categoryId = CategoryRegistry::getInstance()->intern(category, amount >= 0 ? 1 : 0);
+        categoryIndex.insert(category, categoryId);
+        m_categoryCount = qMax(m_categoryCount, categoryId + 1);
+    }
+
+    quint8 flags = 0;
+    if (amount >= 0) flags |= IncomeFlag;
+    if (isDeleted) flags |= DeletedFlag;
+    if (!timestampOk) flags |= UntimedFlag;
+
+    m_timestamps.append(timestampOk ? timestamp : 0);
+    // 金额以分为单位保存，汇总时用整数累加，不产生浮点误差
+    m_amountCents.append(qRound64(amount * 100));
+    m_categoryIds.append(categoryId);
+    m_flags.append(flags);
+}
+
+qint64 RecordColumns::bytes() const {
+    return qint64(size()) * (sizeof(qint64) * 2 + sizeof(int) + sizeof(quint8));
+}
+
+// ============ 汇总 ============
+qint64 RecordColumns::incomeCents() const {
+    qint64 total = 0;
+    const qint64* amounts = m_amountCents.constData();
+    for (int i = 0, n = size(); i < n; ++i) {
+        if (amounts[i] > 0) total += amounts[i];
+    }
+    return total;
+}
+
+qint64 RecordColumns::expenseCents() const {
+    qint64 total = 0;
+    const qint64* amounts = m_amountCents.constData();
+    for (int i = 0, n = size(); i < n; ++i) {
+        if (amounts[i] < 0) total -= amounts[i];
+    }
+    return total;
+}
+
+qint64 RecordColumns::balanceCents() const {
+    qint64 total = 0;
+    const qint64* amounts = m_amountCents.constData();
+    for (int i = 0, n = size(); i < n; ++i) {
+        total += amounts[i];
+    }
+    return total;
+}
+
+QList<qint64> RecordColumns::sumByCategory(bool onlyExpense) const {
+    QList<qint64> sums(m_categoryCount, 0);
+    const qint64* amounts = m_amountCents.constData();
+    const int* categories = m_categoryIds.constData();
+    const quint8* flags = m_flags.constData();
+    for (int i = 0, n = size(); i < n; ++i) {
+        bool income = flags[i] & IncomeFlag;
+        if (income == onlyExpense) continue;
+        sums[categories[i]] += onlyExpense ? -amounts[i] : amounts[i];
+    }
+    return sums;
+}
+
+QList<qint64> RecordColumns::netByCategory() const {
+    QList<qint64> sums(m_categoryCount, 0);
+    const qint64* amounts = m_amountCents.constData();
+    const int* categories = m_categoryIds.constData();
+    for (int i = 0, n = size(); i < n; ++i) {
+        sums[categories[i]] += amounts[i];
+    }
+    return sums;
+}
+
+QList<int> RecordColumns::countByCategory() const {
+    QList<int> counts(m_categoryCount, 0);
+    const int* categories = m_categoryIds.constData();
+    for (int i = 0, n = size(); i < n; ++i) {
+        ++counts[categories[i]];
+    }
+    return counts;
+}
+
+void RecordColumns::sumByDay(qint64 firstDay, int days, QList<qint64>& income, QList<qint64>& expense) const {
+    income = QList<qint64>(days, 0);
+    expense = QList<qint64>(days, 0);
+    const qint64* timestamps = m_timestamps.constData();
+    const qint64* amounts = m_amountCents.constData();
+    const quint8* flags = m_flags.constData();
+    for (int i = 0, n = size(); i < n; ++i) {
+        if ((flags[i] & UntimedFlag) || timestamps[i] < firstDay) continue;
+        qint64 day = (timestamps[i] - firstDay) / TimestampParser::SecsPerDay;
+        if (day >= days) continue;
+        if (amounts[i] >= 0) {
+            income[day] += amounts[i];
+        } else {
+            expense[day] -= amounts[i];
+        }
+    }
+}
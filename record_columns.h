@@ -0,0 +1,67 @@
+#ifndef RECORD_COLUMNS_H
+#define RECORD_COLUMNS_H
+
+#include "account_record.h"
+#include <QList>
+#include <QHash>
+#include <QString>
+#include <QDate>
+
+/**
+ * @brief 账单列式快照 - 只保留统计需要的字段，每个字段一段连续数组：
+ *        时间戳（秒）、金额（分）、分类编号、标志位。分类编号来自 CategoryRegistry，
+ *        汇总时只遍历整数数组，不再逐条拷贝分类、备注、时间等字符串。
+ *        快照创建后只读，复制时共享底层数组。
+ */
+class RecordColumns
+{
+public:
+    enum Flag : quint8 {
+        IncomeFlag = 0x01,    // 金额 >= 0
+        DeletedFlag = 0x02,   // 已移入回收站
+        UntimedFlag = 0x04    // 记账时间无法解析（时间戳为 0，不参与按天汇总）
+    };
+
+    // 从已解码的记录构建
+    static RecordColumns fromRecords(const QList<AccountRecord>& records);
+
+    static double toYuan(qint64 cents) { return cents / 100.0; }
+
+    int size() const { return m_amountCents.size(); }
+    bool isEmpty() const { return m_amountCents.isEmpty(); }
+    const QList<qint64>& timestamps() const { return m_timestamps; }
+    const QList<qint64>& amountCents() const { return m_amountCents; }
+    const QList<int>& categoryIds() const { return m_categoryIds; }
+    const QList<quint8>& flags() const { return m_flags; }
+    // 快照中最大的分类编号 + 1，按分类汇总的数组长度
+    int categoryCount() const { return m_categoryCount; }
+    // 估算占用的字节数
+    qint64 bytes() const;
+
+    // ============ 汇总（单位：分） ============
+    qint64 incomeCents() const;
+    // 支出合计（正数）
+    qint64 expenseCents() const;
+    qint64 balanceCents() const;
+    // 按分类汇总，下标为分类编号；onlyExpense 为 true 时只汇总支出（正数），否则只汇总收入
+    QList<qint64> sumByCategory(bool onlyExpense) const;
+    // 按分类汇总收支净额，下标为分类编号
+    QList<qint64> netByCategory() const;
+    // 每个分类的记录条数，下标为分类编号（区分“没有记录”与“净额为 0”）
+    QList<int> countByCategory() const;
+    // 从 firstDay 零点起按天汇总 days 天，下标为天序号（支出为正数）
+    void sumByDay(qint64 firstDay, int days, QList<qint64>& income, QList<qint64>& expense) const;
+
+private:
+    void reserve(int count);
+    void append(qint64 timestamp, bool timestampOk, double amount, const QString& category, bool isDeleted,
+                QHash<QString, int>& categoryIndex);
+
+    QList<qint64> m_timestamps;
+    QList<qint64> m_amountCents;
+    QList<int> m_categoryIds;
+    QList<quint8> m_flags;
+    int m_categoryCount = 0;
+};
+
+#endif // RECORD_COLUMNS_H
@@ -1,4 +1,5 @@
 #include "server_main.h"
+#include "sqlite_helper.h"
 #include <QDebug>
 #include <QTcpSocket>
 
@@ -36,11 +37,20 @@ bool server_main::startServer(quint16 port)
         qDebug() << "服务器主程序启动成功，监听端口:" << port;
     }
     
-    // 初始化数据库管理器 (使用服务器专用数据库文件)
+    // 初始化数据库管理器：单独运行时使用服务器专用数据库文件；与客户端同进程运行时
+    // SqliteHelper 单例已打开客户端数据库，一个进程只能打开一个文件，服务器共用它并切换到服务端配置档
+    QString serverDbPath = SqliteHelper::getInstance()->databasePath();
+    if (serverDbPath.isEmpty()) {
+        serverDbPath = "./server_account_book.db";
+    } else {
+        qDebug() << "服务器与客户端同进程运行，共用数据库：" << serverDbPath;
+    }
     s_dbmanger = DBManager::getInstance();
-    s_dbmanger->initialize("./server_account_book.db");
-    
-    qDebug() << "服务器 SQLite 数据库初始化完成";
+    if (s_dbmanger->initialize(serverDbPath, "server-throughput")) {
+        qDebug() << "服务器 SQLite 数据库初始化完成";
+    } else {
+        qWarning() << "服务器 SQLite 数据库初始化失败：" << SqliteHelper::getInstance()->getLastError();
+    }
     
     return success;
 }
@@ -77,6 +87,10 @@ void server_main::onMessageReceived(qintptr socketDescriptor, const QJsonObject&
         // 处理编辑记账记录请求
         response = m_billHandler->handleEditRecord(message);
     }
+    else if (type == "batch_edit_records") {
+        // 处理批量编辑记账记录请求
+        response = m_billHandler->handleBatchEditRecords(message);
+    }
     else if (type == "delete_record") {
         // 处理删除记账记录请求
         response = m_billHandler->handleDeleteRecord(message);
@@ -101,6 +115,10 @@ void server_main::onMessageReceived(qintptr socketDescriptor, const QJsonObject&
         // 处理备份数据请求
         response = m_billHandler->handleBackupData(message);
     }
+    else if (type == "server_status") {
+        // 处理服务器状态查询请求
+        response = m_billHandler->handleServerStatus(message);
+    }
     else {
         // 未知消息类型
         response["type"] = "error_response";
@@ -0,0 +1,466 @@
+#include "sqlite_backup.h"
+#include "sqlite_helper.h"
+#include "category_registry.h"
+#include "range_sum_index.h"
+#include "budget_manager.h"
+#include "thread_manager.h"
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QThread>
+#include <QSqlQuery>
+#include <QSet>
+#include <QDebug>
+#ifdef ACCOUNTBOOK_SYSTEM_SQLITE
+#include <sqlite3.h>
+#endif
+
+namespace {
+// 源库在备份期间被其他连接修改时 SQLite 会从头重来，超过该次数后改为一步完成
+const int kMaxRestarts = 3;
+// 连续遇到锁冲突的最大重试次数
+const int kMaxBusyRetries = 200;
+
+// 逐表恢复时跳过的表：由触发器维护的派生表与版本号表（保留当前库的结构版本）
+bool isDerivedTable(const QString& name)
+{
+    return name == "daily_rollup" || name == "rollup_revision" || name == "db_version"
+           || name.startsWith("account_record_fts");
+}
+
+#ifdef ACCOUNTBOOK_SYSTEM_SQLITE
+// 取出 QSQLITE 驱动底层的 sqlite3 句柄
+sqlite3* sqliteHandle(const QSqlDatabase& db)
+{
+    if (!db.isValid() || !db.driver()) {
+        return nullptr;
+    }
+    QVariant handle = db.driver()->handle();
+    if (handle.isValid() && qstrcmp(handle.typeName(), "sqlite3*") == 0) {
+        return *static_cast<sqlite3* const*>(handle.constData());
+    }
+    return nullptr;
+}
+#endif
+}
+
+SqliteBackup::SqliteBackup(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void SqliteBackup::setPagesPerStep(int pages)
+{
+    m_pagesPerStep = qMax(1, pages);
+}
+
+void SqliteBackup::setStepInterval(int msecs)
+{
+    m_stepIntervalMs = qMax(0, msecs);
+}
+
+// ============ 逐步复制 ============
+bool SqliteBackup::hasBackupApi(const QSqlDatabase& db)
+{
+#ifdef ACCOUNTBOOK_SYSTEM_SQLITE
+    // 版本不同一定不是同一份 SQLite（驱动仍使用 Qt 自带的副本），此时不能把句柄交给 libsqlite3
+    QSqlQuery query(db);
+    if (!query.exec("SELECT sqlite_version()") || !query.next()) {
+        return false;
+    }
+    bool same = query.value(0).toString() == QString::fromLatin1(sqlite3_libversion());
+    if (!same) {
+        qDebug() << "QSQLITE 驱动的 SQLite 版本与链接的 libsqlite3 不同，改用 VACUUM INTO / 逐表复制";
+    }
+    return same && sqliteHandle(db) != nullptr;
+#else
+    Q_UNUSED(db);
+    return false;
+#endif
+}
+
+bool SqliteBackup::copyPages(const QSqlDatabase& source, const QSqlDatabase& dest,
+                             int pagesPerStep, int stepIntervalMs,
+                             const std::function<bool(int, int)>& onProgress,
+                             QString* error)
+{
+#ifndef ACCOUNTBOOK_SYSTEM_SQLITE
+    Q_UNUSED(source);
+    Q_UNUSED(dest);
+    Q_UNUSED(pagesPerStep);
+    Q_UNUSED(stepIntervalMs);
+    Q_UNUSED(onProgress);
+    if (error) *error = "未以 CONFIG+=system_sqlite 构建，backup API 不可用";
+    return false;
+#else
+    sqlite3* sourceHandle = sqliteHandle(source);
+    sqlite3* destHandle = sqliteHandle(dest);
+    if (!sourceHandle || !destHandle) {
+        if (error) *error = "无法获取 SQLite 连接句柄";
+        return false;
+    }
+
+    sqlite3_backup* backup = sqlite3_backup_init(destHandle, "main", sourceHandle, "main");
+    if (!backup) {
+        if (error) *error = QString::fromUtf8(sqlite3_errmsg(destHandle));
+        return false;
+    }
+
+    int step = pagesPerStep;
+    int restarts = 0;
+    int busyRetries = 0;
+    int lastRemaining = -1;
+    bool aborted = false;
+    int rc = SQLITE_OK;
+
+    while (true) {
+        rc = sqlite3_backup_step(backup, step);
+        int total = sqlite3_backup_pagecount(backup);
+        int remaining = sqlite3_backup_remaining(backup);
+
+        if (rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+            if (++busyRetries > kMaxBusyRetries) break;
+            QThread::msleep(qMax(stepIntervalMs, 1));
+            continue;
+        }
+        busyRetries = 0;
+
+        // 剩余页数变多说明源库被改动、备份已重新开始
+        if (lastRemaining >= 0 && remaining > lastRemaining && ++restarts >= kMaxRestarts) {
+            qDebug() << "备份多次因写入重新开始，剩余页改为一步复制";
+            step = -1;
+        }
+        lastRemaining = remaining;
+
+        if (onProgress && !onProgress(total - remaining, total)) {
+            aborted = true;
+            break;
+        }
+        if (rc != SQLITE_OK) break;
+
+        // 步与步之间让出锁，其他连接可以继续读写
+        if (stepIntervalMs > 0) {
+            QThread::msleep(stepIntervalMs);
+        }
+    }
+
+    sqlite3_backup_finish(backup);
+
+    if (aborted) {
+        if (error) *error = "操作已取消";
+        return false;
+    }
+    if (rc != SQLITE_DONE) {
+        if (error) *error = QString::fromUtf8(sqlite3_errstr(rc));
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool SqliteBackup::copyByVacuum(const QSqlDatabase& source, const QString& filePath, QString* error)
+{
+    // VACUUM INTO 在一个读事务内完成，得到的是某一时刻的一致副本，期间不阻塞其他连接写入
+    QSqlQuery query(source);
+    query.prepare("VACUUM INTO ?");
+    query.addBindValue(filePath);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool SqliteBackup::copyTables(const QSqlDatabase& dest, const QString& backupFilePath,
+                              const std::function<bool(int, int)>& onProgress,
+                              QString* error)
+{
+    SqliteHelper* helper = SqliteHelper::getInstance();
+    QSqlQuery query(dest);
+    query.prepare("ATTACH DATABASE ? AS restore_src");
+    query.addBindValue(backupFilePath);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+
+    // 表名 -> 可写入的列（排除生成列等隐藏列）
+    auto tableColumns = [&query](const QString& schema) {
+        QMap<QString, QStringList> tables;
+        QStringList names;
+        query.exec(QString("SELECT name FROM %1.sqlite_master WHERE type = 'table' "
+                           "AND name NOT LIKE 'sqlite_%'").arg(schema));
+        while (query.next()) {
+            QString name = query.value(0).toString();
+            if (!isDerivedTable(name)) names << name;
+        }
+        for (const QString& name : names) {
+            query.exec(QString("SELECT name FROM pragma_table_xinfo('%1', '%2') WHERE hidden = 0")
+                           .arg(name, schema));
+            QStringList columns;
+            while (query.next()) {
+                columns << query.value(0).toString();
+            }
+            tables.insert(name, columns);
+        }
+        query.finish();
+        return tables;
+    };
+    QMap<QString, QStringList> mainTables = tableColumns("main");
+    QMap<QString, QStringList> sourceTables = tableColumns("restore_src");
+
+    bool ok = helper->beginTransaction();
+    QString failure;
+    if (ok) {
+        // 外键检查推迟到提交时，删除与插入的先后顺序不受父子表关系限制
+        ok = query.exec("PRAGMA defer_foreign_keys = ON");
+    }
+    // 先清空全部基础表（备份中没有的表恢复后也为空），再按两边共有的列逐表复制
+    for (auto it = mainTables.constBegin(); ok && it != mainTables.constEnd(); ++it) {
+        ok = query.exec(QString("DELETE FROM main.\"%1\"").arg(it.key()));
+    }
+    int copied = 0;
+    for (auto it = mainTables.constBegin(); ok && it != mainTables.constEnd(); ++it) {
+        QStringList columns;
+        for (const QString& column : it.value()) {
+            if (sourceTables.value(it.key()).contains(column)) columns << "\"" + column + "\"";
+        }
+        if (!columns.isEmpty()) {
+            ok = query.exec(QString("INSERT INTO main.\"%1\" (%2) SELECT %2 FROM restore_src.\"%1\"")
+                                .arg(it.key(), columns.join(", ")));
+        }
+        if (ok && onProgress && !onProgress(++copied, mainTables.size())) {
+            failure = "操作已取消";
+            ok = false;
+        }
+    }
+    // 自增序列一并恢复，之后新增的记录不会复用备份中已有的 id
+    // （sqlite_sequence 的 name 没有唯一约束，先整表清空再插入）
+    if (ok) ok = query.exec("DELETE FROM main.sqlite_sequence")
+                 && query.exec("INSERT INTO main.sqlite_sequence (name, seq) "
+                               "SELECT name, seq FROM restore_src.sqlite_sequence");
+    if (!ok && failure.isEmpty()) {
+        failure = query.lastError().text();
+    }
+    query.finish();
+    if (ok) {
+        ok = helper->commitTransaction();
+        if (!ok) failure = helper->getLastError();
+    }
+    if (!ok) {
+        helper->rollbackTransaction();
+    }
+    query.exec("DETACH DATABASE restore_src");
+    query.finish();
+
+    if (!ok && error) *error = failure;
+    return ok;
+}
+
+// ============ 同步执行 ============
+bool SqliteBackup::backup(const QString& backupDir, int keepCount)
+{
+    SqliteHelper* helper = SqliteHelper::getInstance();
+    QSqlDatabase source = helper->getDatabase();
+    if (!source.isOpen()) {
+        m_lastError = "数据库未打开";
+        return finish(false, QString());
+    }
+
+    QDir dir(backupDir);
+    if (!dir.exists() && !dir.mkpath(backupDir)) {
+        m_lastError = "无法创建备份目录：" + backupDir;
+        return finish(false, QString());
+    }
+
+    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd_HH-mm-ss");
+    QString backupFilePath = backupDir + "/account_book_" + timestamp + ".db";
+    // 先写临时文件，完成后再改名，避免半成品出现在备份列表中
+    QString partialPath = backupFilePath + ".part";
+    QFile::remove(partialPath);
+
+    QString error;
+    bool ok = false;
+    if (hasBackupApi(source)) {
+        QString connectionName;
+        QSqlDatabase dest = openSideConnection(partialPath, false, &connectionName);
+        if (!dest.isOpen()) {
+            m_lastError = "无法创建备份文件：" + dest.lastError().text();
+            dest = QSqlDatabase();
+            closeSideConnection(connectionName);
+            return finish(false, backupFilePath);
+        }
+        ok = copyPages(source, dest, m_pagesPerStep, m_stepIntervalMs,
+                       [this](int copied, int total) { return reportProgress(copied, total); },
+                       &error);
+        dest = QSqlDatabase();
+        closeSideConnection(connectionName);
+    } else if (!reportProgress(0, 1)) {
+        error = "操作已取消";
+    } else {
+        ok = copyByVacuum(source, partialPath, &error);
+        if (ok) reportProgress(1, 1);
+    }
+
+    if (ok) {
+        QFile::remove(backupFilePath);
+        ok = QFile::rename(partialPath, backupFilePath);
+        if (!ok) error = "无法重命名备份文件";
+    }
+    if (!ok) {
+        QFile::remove(partialPath);
+        m_lastError = "备份失败：" + error;
+        return finish(false, backupFilePath);
+    }
+
+    m_lastBackupPath = backupFilePath;
+    qDebug() << "备份成功：" << backupFilePath;
+
+    // 清理过期备份（仅保留最近 keepCount 个）
+    QStringList backups = helper->listBackups(backupDir);
+    if (backups.size() > keepCount) {
+        for (int i = 0; i < backups.size() - keepCount; ++i) {
+            helper->deleteBackup(backupDir + "/" + backups[i]);
+        }
+    }
+
+    return finish(true, backupFilePath);
+}
+
+bool SqliteBackup::restore(const QString& backupFilePath)
+{
+    if (!QFile::exists(backupFilePath)) {
+        m_lastError = "备份文件不存在：" + backupFilePath;
+        return finish(false, backupFilePath);
+    }
+
+    SqliteHelper* helper = SqliteHelper::getInstance();
+    // 写回期间关闭同步：中途失败时数据库本来就需要重新恢复
+    SqliteHelper::ScopedDurabilityProfile bulkProfile(helper, "bulk-import");
+    // 本线程缓存的语句可能仍持有读事务，目标连接上有事务时无法开始写回
+    helper->clearStatementCache();
+    QSqlDatabase dest = helper->getDatabase();
+    if (!dest.isOpen()) {
+        m_lastError = "数据库未打开";
+        return finish(false, backupFilePath);
+    }
+
+    QString error;
+    bool ok = false;
+    if (hasBackupApi(dest)) {
+        QString connectionName;
+        QSqlDatabase source = openSideConnection(backupFilePath, true, &connectionName);
+        if (!source.isOpen()) {
+            m_lastError = "无法打开备份文件：" + source.lastError().text();
+            source = QSqlDatabase();
+            closeSideConnection(connectionName);
+            return finish(false, backupFilePath);
+        }
+        ok = copyPages(source, dest, m_pagesPerStep, m_stepIntervalMs,
+                       [this](int copied, int total) { return reportProgress(copied, total); },
+                       &error);
+        source = QSqlDatabase();
+        closeSideConnection(connectionName);
+    } else {
+        ok = copyTables(dest, backupFilePath,
+                        [this](int copied, int total) { return reportProgress(copied, total); },
+                        &error);
+    }
+
+    if (!ok) {
+        m_lastError = "恢复失败：" + error;
+        return finish(false, backupFilePath);
+    }
+
+    // 页复制与逐表复制都绕过了 SqliteHelper 的写入接口，由这里统一递增写入计数，
+    // 统计、月度缓存、区间合计和预算计数在下次读取时发现计数变化后自行作废
+    helper->markDataReplaced();
+    // 以下内容不随写入计数失效：bill_category ID 缓存、预算规则，
+    // 以及按 rollup_revision 校验的区间合计旁路文件（恢复后的版本号可能与旧文件碰巧相同）
+    CategoryRegistry::getInstance()->clearBillCategoryIds();
+    BudgetManager::getInstance()->clear();
+    RangeSumIndex::getInstance()->clear();
+    QFile::remove(RangeSumIndex::defaultFilePath());
+    qDebug() << "恢复备份成功：" << backupFilePath;
+    return finish(true, backupFilePath);
+}
+
+// ============ 异步执行 ============
+bool SqliteBackup::startBackup(const QString& backupDir, int keepCount)
+{
+    if (!m_running.testAndSetOrdered(0, 1)) {
+        qDebug() << "备份/恢复任务正在进行中";
+        return false;
+    }
+    m_cancelled.storeRelaxed(0);
+    ThreadManager::getInstance()->runAsync([this, backupDir, keepCount]() {
+        backup(backupDir, keepCount);
+        m_running.storeRelease(0);
+    });
+    return true;
+}
+
+bool SqliteBackup::startRestore(const QString& backupFilePath)
+{
+    if (!m_running.testAndSetOrdered(0, 1)) {
+        qDebug() << "备份/恢复任务正在进行中";
+        return false;
+    }
+    m_cancelled.storeRelaxed(0);
+    ThreadManager::getInstance()->runAsync([this, backupFilePath]() {
+        restore(backupFilePath);
+        m_running.storeRelease(0);
+    });
+    return true;
+}
+
+void SqliteBackup::cancel()
+{
+    m_cancelled.storeRelaxed(1);
+}
+
+bool SqliteBackup::isRunning() const
+{
+    return m_running.loadAcquire() != 0;
+}
+
+// ============ 私有方法 ============
+bool SqliteBackup::reportProgress(int copiedPages, int totalPages)
+{
+    emit progress(copiedPages, totalPages);
+    return m_cancelled.loadRelaxed() == 0;
+}
+
+bool SqliteBackup::finish(bool success, const QString& filePath)
+{
+    if (!success) {
+        qDebug() << m_lastError;
+    }
+    m_cancelled.storeRelaxed(0);
+    emit finished(success, filePath, success ? QString() : m_lastError);
+    return success;
+}
+
+QSqlDatabase SqliteBackup::openSideConnection(const QString& filePath, bool readOnly, QString* connectionName)
+{
+    static QAtomicInteger<int> serial;
+    *connectionName = QString("account_book_backup_%1").arg(serial.fetchAndAddRelaxed(1));
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", *connectionName);
+    db.setDatabaseName(filePath);
+    db.setConnectOptions(readOnly ? "QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000"
+                                  : "QSQLITE_BUSY_TIMEOUT=5000");
+    db.open();
+    return db;
+}
+
+void SqliteBackup::closeSideConnection(const QString& connectionName)
+{
+    {
+        QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+        if (db.isOpen()) db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
@@ -0,0 +1,78 @@
+#ifndef SQLITE_BACKUP_H
+#define SQLITE_BACKUP_H
+
+#include <QObject>
+#include <QString>
+#include <QSqlDatabase>
+#include <QAtomicInteger>
+#include <functional>
+
+/**
+ * @brief 在线备份引擎 - 以 CONFIG+=system_sqlite 构建且驱动确实使用同一份 SQLite 时，
+ *        基于 SQLite backup API 每步只复制固定页数，步与步之间释放锁并让出时间片；
+ *        否则备份用 VACUUM INTO 生成一致的副本，恢复用 ATTACH 在一个事务内逐表复制。
+ *        两种方式备份/恢复期间数据库都仍可正常读写
+ */
+class SqliteBackup : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SqliteBackup(QObject* parent = nullptr);
+
+    // 每步复制的页数（默认 256 页）
+    void setPagesPerStep(int pages);
+    // 两步之间的休眠时间（毫秒，默认 10）
+    void setStepInterval(int msecs);
+
+    // ============ 同步执行（在调用线程完成） ============
+    // 备份当前数据库到 backupDir，文件名带时间戳，仅保留最近 keepCount 个
+    bool backup(const QString& backupDir = "./backups", int keepCount = 10);
+    // 将备份文件逐页写回当前数据库（不删除、不重新打开数据库文件）
+    bool restore(const QString& backupFilePath);
+
+    // ============ 异步执行（在 ThreadManager 线程池中完成，结果通过信号通知） ============
+    // 执行期间不要销毁本对象
+    bool startBackup(const QString& backupDir = "./backups", int keepCount = 10);
+    bool startRestore(const QString& backupFilePath);
+    // 请求取消，当前步完成后停止
+    void cancel();
+    bool isRunning() const;
+
+    QString lastError() const { return m_lastError; }
+    QString lastBackupPath() const { return m_lastBackupPath; }
+
+    // 当前构建与 QSQLITE 驱动能否使用 backup API（驱动必须链接同一份 SQLite）
+    static bool hasBackupApi(const QSqlDatabase& db);
+    // 逐步把 source 的 main 库复制到 dest，onProgress 返回 false 时中止（需要 hasBackupApi）
+    static bool copyPages(const QSqlDatabase& source, const QSqlDatabase& dest,
+                          int pagesPerStep, int stepIntervalMs,
+                          const std::function<bool(int copiedPages, int totalPages)>& onProgress,
+                          QString* error);
+
+signals:
+    void progress(int copiedPages, int totalPages);
+    void finished(bool success, const QString& filePath, const QString& errorMessage);
+
+private:
+    bool reportProgress(int copiedPages, int totalPages);
+    bool finish(bool success, const QString& filePath);
+    // 在当前线程打开一个指向 filePath 的临时连接
+    static QSqlDatabase openSideConnection(const QString& filePath, bool readOnly, QString* connectionName);
+    static void closeSideConnection(const QString& connectionName);
+    // 无 backup API 时的备份：VACUUM INTO 写出 source 在同一读事务下的一致副本
+    static bool copyByVacuum(const QSqlDatabase& source, const QString& filePath, QString* error);
+    // 无 backup API 时的恢复：ATTACH 备份文件，在一个写事务内清空并逐表复制基础表，
+    // 每日汇总、全文索引等派生表由触发器随之更新；onProgress 按表报告进度
+    static bool copyTables(const QSqlDatabase& dest, const QString& backupFilePath,
+                           const std::function<bool(int copiedTables, int totalTables)>& onProgress,
+                           QString* error);
+
+    int m_pagesPerStep = 256;
+    int m_stepIntervalMs = 10;
+    QAtomicInteger<int> m_running;
+    QAtomicInteger<int> m_cancelled;
+    QString m_lastError;
+    QString m_lastBackupPath;
+};
+
+#endif // SQLITE_BACKUP_H
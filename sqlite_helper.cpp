@@ -1,18 +1,32 @@
 #include "sqlite_helper.h"
+#include "sqlite_backup.h"
 #include <QDebug>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlRecord>
 #include <QFile>
+#include <QFileInfo>
 #include <QDir>
 #include <QDateTime>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QRegularExpression>
 
 // 静态成员初始化
 SqliteHelper* SqliteHelper::m_instance = nullptr;
 QMutex SqliteHelper::m_mutex;
 
-SqliteHelper::SqliteHelper() {}
+SqliteHelper::SqliteHelper()
+    : m_profile(DurabilityProfile::interactiveClient()) {
+    m_planDiagnostics = qEnvironmentVariableIsSet("ACCOUNTBOOK_EXPLAIN_QUERIES");
+    registerDefaultHotQueries();
+}
 
 SqliteHelper::~SqliteHelper() {
+    if (m_dbPool) {
+        m_dbPool->waitForDone();
+        delete m_dbPool;
+    }
     closeDatabase();
 }
 
@@ -27,29 +41,351 @@ SqliteHelper* SqliteHelper::getInstance() {
     return m_instance;
 }
 
-bool SqliteHelper::openDatabase(const QString& dbPath) {
-    m_dbPath = dbPath;
+// ============ 持久化配置档 ============
+SqliteHelper::DurabilityProfile SqliteHelper::DurabilityProfile::interactiveClient() {
+    DurabilityProfile profile;
+    profile.name = "interactive-client";
+    profile.journalMode = "WAL";
+    profile.synchronous = "NORMAL";
+    profile.mmapSize = 64LL * 1024 * 1024;
+    profile.cacheSize = -8000;
+    profile.tempStore = "MEMORY";
+    profile.walAutoCheckpoint = 1000;
+    return profile;
+}
+
+SqliteHelper::DurabilityProfile SqliteHelper::DurabilityProfile::serverThroughput() {
+    DurabilityProfile profile;
+    profile.name = "server-throughput";
+    profile.journalMode = "WAL";
+    profile.synchronous = "NORMAL";
+    profile.mmapSize = 256LL * 1024 * 1024;
+    profile.cacheSize = -32000;
+    profile.tempStore = "MEMORY";
+    profile.walAutoCheckpoint = 4000;
+    return profile;
+}
+
+SqliteHelper::DurabilityProfile SqliteHelper::DurabilityProfile::bulkImport() {
+    DurabilityProfile profile;
+    profile.name = "bulk-import";
+    profile.journalMode = "WAL";
+    profile.synchronous = "OFF";
+    profile.mmapSize = 256LL * 1024 * 1024;
+    profile.cacheSize = -64000;
+    profile.tempStore = "MEMORY";
+    profile.walAutoCheckpoint = 0;
+    return profile;
+}
+
+SqliteHelper::DurabilityProfile SqliteHelper::DurabilityProfile::byName(const QString& name, bool* ok) {
+    if (ok) *ok = true;
+    if (name == "interactive-client") return interactiveClient();
+    if (name == "server-throughput") return serverThroughput();
+    if (name == "bulk-import") return bulkImport();
+    if (ok) *ok = false;
+    return interactiveClient();
+}
+
+// ============ 连接池 ============
+SqliteHelper::ThreadConnection::~ThreadConnection() {
+    release();
+}
+
+void SqliteHelper::ThreadConnection::release() {
+    // 缓存的语句持有驱动句柄，必须先于连接关闭释放
+    clearStatements();
+    if (name.isEmpty()) return;
+    {
+        // QSqlDatabase 句柄必须先于 removeDatabase 析构
+        QSqlDatabase db = QSqlDatabase::database(name, false);
+        if (db.isOpen()) db.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+    name.clear();
+    generation = -1;
+    profileGeneration = -1;
+    inTransaction = false;
+}
+
+void SqliteHelper::ThreadConnection::clearStatements() {
+    statements.clear();
+    statementLru.clear();
+}
+
+void SqliteHelper::ThreadConnection::touchStatement(const QString& sql) {
+    statementLru.removeOne(sql);
+    statementLru.append(sql);
+}
+
+int SqliteHelper::ThreadConnection::trimStatements(int capacity) {
+    int evicted = 0;
+    while (statementLru.size() > capacity) {
+        statements.erase(statementLru.takeFirst());
+        ++evicted;
+    }
+    return evicted;
+}
+
+SqliteHelper::ThreadConnection* SqliteHelper::threadContext() {
+    if (!m_connections.hasLocalData()) {
+        m_connections.setLocalData(new ThreadConnection());
+    }
+    return m_connections.localData();
+}
+
+QSqlDatabase SqliteHelper::connection() {
+    ThreadConnection* ctx = threadContext();
+    int generation = m_generation.loadAcquire();
 
-    // 检查连接是否已存在
-    if (QSqlDatabase::contains("qt_sql_default_connection")) {
-        m_db = QSqlDatabase::database("qt_sql_default_connection");
-        if (m_db.isOpen()) return true;  // 已打开直接返回
-        else return m_db.open();  // 关闭状态则重新打开
+    // 数据库被关闭或重新打开过，丢弃本线程的旧连接
+    if (!ctx->name.isEmpty() && ctx->generation != generation) {
+        ctx->release();
+    }
+    if (!ctx->name.isEmpty()) {
+        QSqlDatabase db = QSqlDatabase::database(ctx->name, false);
+        // 配置档已切换：在事务之外补应用
+        if (!ctx->inTransaction && ctx->profileGeneration != m_profileGeneration.loadAcquire()) {
+            configureConnection(db);
+        }
+        return db;
     }
 
-    // 创建新连接
-    m_db = QSqlDatabase::addDatabase("QSQLITE");
-    m_db.setDatabaseName(dbPath);
+    QString dbPath;
+    {
+        QMutexLocker locker(&m_poolMutex);
+        dbPath = m_dbPath;
+    }
+    if (dbPath.isEmpty()) {
+        return QSqlDatabase();
+    }
+
+    QString name = QString("account_book_conn_%1").arg(m_connectionSerial.fetchAndAddRelaxed(1));
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+    db.setDatabaseName(dbPath);
+    // 多连接并发写入时等待锁释放，而不是立即返回 SQLITE_BUSY
+    db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+    if (!db.open()) {
+        setLastError("数据库打开失败：" + db.lastError().text());
+        qDebug() << getLastError();
+        // 打开失败的连接不登记到本线程，下次访问重新尝试打开
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+        return QSqlDatabase();
+    }
+    ctx->name = name;
+    ctx->generation = generation;
+
+    configureConnection(db);
+    qDebug() << "线程" << QThread::currentThreadId() << "打开数据库连接：" << ctx->name;
+    return db;
+}
+
+void SqliteHelper::configureConnection(QSqlDatabase& db) {
+    // 外键约束是连接级设置，每个连接都要单独开启
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA foreign_keys = ON")) {
+        qDebug() << "开启外键约束失败：" << query.lastError().text();
+    }
+
+    int profileGeneration = m_profileGeneration.loadAcquire();
+    DurabilityProfile profile;
+    {
+        QMutexLocker locker(&m_poolMutex);
+        profile = m_profile;
+    }
+    applyDurabilityProfile(db, profile);
+    threadContext()->profileGeneration = profileGeneration;
+}
+
+void SqliteHelper::applyDurabilityProfile(QSqlDatabase& db, const DurabilityProfile& profile) {
+    QStringList pragmas;
+    pragmas << QString("PRAGMA journal_mode = %1").arg(profile.journalMode)
+            << QString("PRAGMA synchronous = %1").arg(profile.synchronous)
+            << QString("PRAGMA mmap_size = %1").arg(profile.mmapSize)
+            << QString("PRAGMA cache_size = %1").arg(profile.cacheSize)
+            << QString("PRAGMA temp_store = %1").arg(profile.tempStore)
+            << QString("PRAGMA wal_autocheckpoint = %1").arg(profile.walAutoCheckpoint);
+
+    QSqlQuery query(db);
+    for (const QString& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qDebug() << "设置配置档" << profile.name << "失败：" << pragma << query.lastError().text();
+        }
+    }
+}
+
+void SqliteHelper::setLastError(const QString& error) {
+    threadContext()->lastError = error;
+}
+
+bool SqliteHelper::openDatabase(const QString& dbPath, const QString& profileName) {
+    QMutexLocker initLocker(&m_initMutex);
+    QElapsedTimer timer;   // 统计打开耗时（含建立连接与迁移）
+    timer.start();
+
+    bool profileOk = true;
+    DurabilityProfile profile = DurabilityProfile::byName(profileName, &profileOk);
+    if (!profileOk && !profileName.isEmpty()) {
+        qDebug() << "未知的持久化配置档：" << profileName;
+    }
+    QString openedPath;
+    QString openedProfile;
+    {
+        QMutexLocker locker(&m_poolMutex);
+        if (!m_initialized) {
+            m_dbPath = dbPath.isEmpty() ? QString("./account_book.db") : dbPath;
+            m_profile = profile;
+            m_profileGeneration.fetchAndAddOrdered(1);
+        } else {
+            openedPath = m_dbPath;
+            openedProfile = m_profile.name;
+        }
+    }
+
+    // 已经打开过：单例在一个进程内只对应一个数据库文件，换文件必须失败而不是悄悄沿用旧文件；
+    // 同一文件换配置档时切换到新配置档
+    if (!openedPath.isEmpty()) {
+        if (!dbPath.isEmpty() && QFileInfo(dbPath).absoluteFilePath() != QFileInfo(openedPath).absoluteFilePath()) {
+            setLastError(QString("数据库已打开：%1，不能再打开 %2").arg(openedPath, dbPath));
+            qDebug() << getLastError();
+            return false;
+        }
+        if (profileOk && profile.name != openedProfile) {
+            qDebug() << "数据库已按配置档" << openedProfile << "打开，切换为" << profile.name;
+            if (!setDurabilityProfile(profile.name)) return false;
+        }
+    }
 
-    if (!m_db.open()) {
-        m_lastError = "数据库打开失败：" + m_db.lastError().text();
-        qDebug() << m_lastError;
+    QSqlDatabase db = connection();
+    if (!db.isOpen()) {
         return false;
     }
 
-    // 启用外键约束（保障用户与收支记录的关联完整性）
-    enableForeignKeys();
-    
+    // 已完成建表初始化，只需保证本线程连接可用
+    {
+        QMutexLocker locker(&m_poolMutex);
+        if (m_initialized) return true;
+    }
+
+    // 按版本号执行尚未应用的迁移；结构已是最新时只需一次版本查询
+    int fromVersion = getCurrentVersion();
+    if (!runMigrations(fromVersion)) {
+        return false;
+    }
+    int toVersion = latestVersion();
+
+    // 全文索引不随版本号登记：每次打开都检查，SQLite 换成支持 FTS5 的版本后即可补建
+    ensureFullTextIndex();
+    if (hasFullTextIndex()) {
+        // 按 bm25 排序的搜索必然需要临时排序，不登记；这里检查带关键字的分页查询
+        registerHotQuery("AccountManager::queryAccountRecordPage(keyword)",
+                         "SELECT id FROM account_record WHERE user_id = ? AND is_deleted = ? "
+                         "AND id IN (SELECT rowid FROM account_record_fts WHERE account_record_fts MATCH ?) "
+                         "ORDER BY create_time DESC, id DESC LIMIT ?");
+    }
+
+    m_lastOpenReport.coldStart = fromVersion < toVersion;
+    m_lastOpenReport.fromVersion = fromVersion;
+    m_lastOpenReport.toVersion = toVersion;
+    m_lastOpenReport.elapsedMs = timer.elapsed();
+    if (m_lastOpenReport.coldStart) {
+        qDebug() << "数据库冷启动：从版本" << fromVersion << "迁移到" << toVersion
+                 << "，耗时" << m_lastOpenReport.elapsedMs << "ms";
+    } else {
+        qDebug() << "数据库热启动：结构已是版本" << toVersion
+                 << "，耗时" << m_lastOpenReport.elapsedMs << "ms";
+    }
+
+    {
+        QMutexLocker locker(&m_poolMutex);
+        m_initialized = true;
+    }
+
+    qDebug() << "数据库初始化成功：" << databasePath();
+    qDebug() << "持久化配置：" << getEffectiveSettings();
+
+    if (m_planDiagnostics) {
+        QStringList issues = explainHotQueries();
+        qDebug() << "查询计划诊断完成，发现问题" << issues.size() << "个";
+    }
+    return true;
+}
+
+// ============ 迁移 ============
+// 迁移按版本号升序登记，每个迁移只执行一次，并与版本号写入放在同一事务中
+QList<SqliteHelper::Migration> SqliteHelper::migrations() const {
+    return {
+        {1, "基础表结构、索引与默认数据", &SqliteHelper::migrateBaselineSchema},
+        {2, "复合与覆盖索引", &SqliteHelper::migrateCompositeIndexes},
+        {3, "增量自动清理", &SqliteHelper::migrateIncrementalVacuum, false},
+        {4, "键集分页索引", &SqliteHelper::migrateKeysetIndex},
+        {5, "回填旧版分类与备注列", &SqliteHelper::migrateLegacyRecordColumns},
+        {6, "账单全文索引", &SqliteHelper::migrateFullTextIndex},
+        {7, "账单时间整数列", &SqliteHelper::migrateBillTimestamp},
+        {8, "统计覆盖索引", &SqliteHelper::migrateStatisticsIndex},
+        {9, "每日汇总表", &SqliteHelper::migrateDailyRollup},
+        {10, "汇总版本号", &SqliteHelper::migrateRollupRevision},
+        {11, "预算规则表", &SqliteHelper::migrateBudgetRules},
+    };
+}
+
+int SqliteHelper::latestVersion() const {
+    QList<Migration> list = migrations();
+    return list.isEmpty() ? 0 : list.last().version;
+}
+
+bool SqliteHelper::runMigrations(int currentVersion) {
+    const QList<Migration> list = migrations();
+    for (const Migration& migration : list) {
+        if (migration.version <= currentVersion) continue;
+
+        QElapsedTimer timer;
+        timer.start();
+        if (!migration.transactional) {
+            // 非事务迁移须可重复执行：中途失败时版本号不变，下次启动重试
+            if (!(this->*migration.apply)() || !setVersion(migration.version)) {
+                setLastError(QString("迁移到版本 %1 失败：%2").arg(migration.version).arg(getLastError()));
+                qDebug() << getLastError();
+                return false;
+            }
+            qDebug() << "已迁移到版本" << migration.version << migration.description
+                     << "，耗时" << timer.elapsed() << "ms";
+            continue;
+        }
+        if (!beginTransaction()) return false;
+        bool ok = (this->*migration.apply)() && setVersion(migration.version);
+        if (!ok || !commitTransaction()) {
+            QString error = getLastError();
+            rollbackTransaction();
+            setLastError(QString("迁移到版本 %1 失败：%2").arg(migration.version).arg(error));
+            qDebug() << getLastError();
+            return false;
+        }
+        qDebug() << "已迁移到版本" << migration.version << migration.description
+                 << "，耗时" << timer.elapsed() << "ms";
+    }
+    return true;
+}
+
+bool SqliteHelper::ensureColumn(const QString& table, const QString& column, const QString& definition) {
+    QSqlQuery query(connection());
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        setLastError("读取表结构失败：" + table + " 错误：" + query.lastError().text());
+        return false;
+    }
+    while (query.next()) {
+        if (query.value(1).toString().compare(column, Qt::CaseInsensitive) == 0) {
+            return true;
+        }
+    }
+    return executeSql(QString("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, definition));
+}
+
+// 版本 1：基础表结构（兼容在引入版本管理之前创建的旧库）
+bool SqliteHelper::migrateBaselineSchema() {
+    if (!createVersionTable()) return false;
+
     // 创建用户表
     QString createUserTable = R"(
         CREATE TABLE IF NOT EXISTS user (
@@ -88,15 +424,20 @@ bool SqliteHelper::openDatabase(const QString& dbPath) {
     )";
     if (!executeSql(createAccountTable)) return false;
 
-    // 升级表结构：确保旧表也有新列
-    executeSql("ALTER TABLE account_record ADD COLUMN category TEXT");
-    executeSql("ALTER TABLE account_record ADD COLUMN remark TEXT");
-    executeSql("ALTER TABLE account_record ADD COLUMN description TEXT");
-    executeSql("ALTER TABLE account_record ADD COLUMN bill_date TEXT");
-    executeSql("ALTER TABLE account_record ADD COLUMN modify_time TEXT");
-    executeSql("ALTER TABLE account_record ADD COLUMN voucher_path TEXT");
-    executeSql("ALTER TABLE account_record ADD COLUMN is_deleted INTEGER DEFAULT 0");
-    executeSql("ALTER TABLE account_record ADD COLUMN delete_time TEXT");
+    // 升级表结构：旧版本建的表可能缺少这些列，只补缺失的
+    const QList<QPair<QString, QString>> legacyColumns = {
+        {"category", "TEXT"},
+        {"remark", "TEXT"},
+        {"description", "TEXT"},
+        {"bill_date", "TEXT"},
+        {"modify_time", "TEXT"},
+        {"voucher_path", "TEXT"},
+        {"is_deleted", "INTEGER DEFAULT 0"},
+        {"delete_time", "TEXT"}
+    };
+    for (const auto& column : legacyColumns) {
+        if (!ensureColumn("account_record", column.first, column.second)) return false;
+    }
 
     // 创建预算表
     QString createBudgetTable = R"(
@@ -183,15 +524,276 @@ bool SqliteHelper::openDatabase(const QString& dbPath) {
     if (!executeSql(createBillTable)) return false;
 
     // 创建索引提升查询性能
-    createIndexes();
-
-    // 初始化数据库版本（用于后续 schema 升级）
-    initializeVersion();
+    if (!createIndexes()) return false;
 
     // 插入默认数据（确保外键约束有基本保障）
-    insertDefaultData();
+    return insertDefaultData();
+}
+
+// 版本 2：索引按热点查询的谓词顺序设计（等值列在前，范围/排序列在后）
+bool SqliteHelper::migrateCompositeIndexes() {
+    QStringList stmts = {
+        // AccountManager::queryAccountRecord / getRecordCount / BudgetManager 的支出汇总：
+        // user_id、is_deleted 等值 + create_time 范围与排序，带上 amount 使汇总查询无需回表
+        "CREATE INDEX IF NOT EXISTS idx_account_user_deleted_time ON account_record(user_id, is_deleted, create_time, amount)",
+        // bill_handler::handleAddRecord 的重复记录检查
+        "CREATE INDEX IF NOT EXISTS idx_account_user_bill_date ON account_record(user_id, bill_date)",
+        // bill_handler::stageBillRow 按 local_id 去重（id 即 rowid，索引即可覆盖）
+        "CREATE INDEX IF NOT EXISTS idx_bill_user_local ON bill(user_id, local_id)",
+        // bill_handler::handleQueryBills / handleBackupData：user_id、is_deleted 等值 + bill_date 范围与排序
+        "CREATE INDEX IF NOT EXISTS idx_bill_user_deleted_date ON bill(user_id, is_deleted, bill_date)",
+        // user_id 单列索引已是上面复合索引的前缀，删除以减少写放大
+        // bill_category 的 (user_id, name) 查询由 UNIQUE 约束自带的索引覆盖，无需新建
+        "DROP INDEX IF EXISTS idx_account_user_id"
+    };
+    for (const QString& sql : stmts) {
+        if (!executeSql(sql)) return false;
+    }
+    // 让查询规划器基于新索引的统计信息选择执行计划
+    return executeSql("ANALYZE");
+}
+
+// 版本 3：已有数据的库要整理一次文件才能切换 auto_vacuum 模式，之后空闲页可按需增量回收
+bool SqliteHelper::migrateIncrementalVacuum() {
+    QSqlQuery query(connection());
+    if (query.exec("PRAGMA auto_vacuum") && query.next() && query.value(0).toInt() == 2) {
+        return true;
+    }
+    query.finish();
+    if (!executeSql("PRAGMA auto_vacuum = INCREMENTAL")) return false;
+    // 有未完成的语句时 VACUUM 会失败，先释放本线程缓存的语句
+    clearStatementCache();
+    return executeSql("VACUUM");
+}
+
+// 版本 4：版本 2 的索引在 create_time 之后是 amount，同一时间的记录不按 id 有序，
+// ORDER BY create_time DESC, id DESC 需要临时 B 树；把 id 放在 amount 之前，仍可覆盖金额汇总
+bool SqliteHelper::migrateKeysetIndex() {
+    QStringList stmts = {
+        "CREATE INDEX IF NOT EXISTS idx_account_user_deleted_time_id ON account_record(user_id, is_deleted, create_time, id, amount)",
+        "DROP INDEX IF EXISTS idx_account_user_deleted_time"
+    };
+    for (const QString& sql : stmts) {
+        if (!executeSql(sql)) return false;
+    }
+    return executeSql("ANALYZE account_record");
+}
+
+// 版本 5：旧版本把分类名存在 type、备注存在 description，一次性回填后读取时不再逐行回退
+bool SqliteHelper::migrateLegacyRecordColumns() {
+    // 新版 type 存 0/1 整数，只有文本才是旧版的分类名
+    QString fillCategory = R"(
+        UPDATE account_record SET category = type
+        WHERE (category IS NULL OR category = '') AND typeof(type) = 'text' AND type <> ''
+    )";
+    if (!executeSql(fillCategory)) return false;
+
+    QString fillRemark = R"(
+        UPDATE account_record SET remark = description
+        WHERE (remark IS NULL OR remark = '') AND description IS NOT NULL AND description <> ''
+    )";
+    return executeSql(fillRemark);
+}
+
+// 版本 6：全文索引曾在这里创建，不支持 FTS5 的环境也会记下版本号，之后不再重试。
+// 现改由 ensureFullTextIndex 在每次打开时检查，此版本保留为空操作，版本号保持连续
+bool SqliteHelper::migrateFullTextIndex() {
+    return true;
+}
 
-    qDebug() << "数据库初始化成功：" << dbPath;
+// 外部内容的 FTS5 表只存倒排索引，正文仍在 account_record，由触发器保持同步。
+// 中文没有词边界，unicode61 分词会把整句当成一个词，改用 trigram 分词按三字切片，
+// 任意位置的子串（包括前缀）都能走索引；不足三个字的关键字仍由调用方退回 LIKE
+bool SqliteHelper::ensureFullTextIndex() {
+    static const QStringList objects = {
+        "account_record_fts", "trg_account_record_fts_insert",
+        "trg_account_record_fts_delete", "trg_account_record_fts_update"
+    };
+    QSqlQuery query(connection());
+    query.prepare(QString("SELECT COUNT(*) FROM sqlite_master WHERE name IN ('%1')").arg(objects.join("', '")));
+    bool complete = query.exec() && query.next() && query.value(0).toInt() == objects.size();
+    query.finish();
+    if (complete) {
+        m_fullTextIndex.storeRelease(1);
+        return true;
+    }
+
+    m_fullTextIndex.storeRelease(0);
+    if (!query.exec("CREATE VIRTUAL TABLE temp.fts_probe USING fts5(x, tokenize='trigram')")) {
+        qDebug() << "SQLite 不支持 FTS5 trigram 分词，暂不建立全文索引：" << query.lastError().text();
+        return false;
+    }
+    query.exec("DROP TABLE temp.fts_probe");
+    query.finish();
+
+    QStringList stmts = fullTextIndexSchema();
+    // 为已有记录建立索引（触发器缺失期间的写入也一并补上）
+    stmts << "INSERT INTO account_record_fts(account_record_fts) VALUES ('rebuild')";
+    // 建表、触发器与重建索引一起提交，中途失败时下次打开从头再来
+    if (!beginTransaction()) return false;
+    for (const QString& sql : stmts) {
+        if (!executeSql(sql)) {
+            rollbackTransaction();
+            return false;
+        }
+    }
+    if (!commitTransaction()) {
+        rollbackTransaction();
+        return false;
+    }
+    qDebug() << "已建立账单全文索引";
+    m_fullTextIndex.storeRelease(1);
+    return true;
+}
+
+QStringList SqliteHelper::fullTextIndexSchema() {
+    return {
+        R"(
+        CREATE VIRTUAL TABLE IF NOT EXISTS account_record_fts USING fts5(
+            category, remark, description,
+            content='account_record', content_rowid='id', tokenize='trigram'
+        )
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_account_record_fts_insert AFTER INSERT ON account_record BEGIN
+            INSERT INTO account_record_fts(rowid, category, remark, description)
+            VALUES (new.id, new.category, new.remark, new.description);
+        END
+        )",
+        // 外部内容表删除索引项时必须带上旧值，FTS5 据此找到要移除的词条
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_account_record_fts_delete AFTER DELETE ON account_record BEGIN
+            INSERT INTO account_record_fts(account_record_fts, rowid, category, remark, description)
+            VALUES ('delete', old.id, old.category, old.remark, old.description);
+        END
+        )",
+        // 只在文本列变化时重建索引项，软删除、改金额等更新不产生额外写入
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_account_record_fts_update
+        AFTER UPDATE OF category, remark, description ON account_record BEGIN
+            INSERT INTO account_record_fts(account_record_fts, rowid, category, remark, description)
+            VALUES ('delete', old.id, old.category, old.remark, old.description);
+            INSERT INTO account_record_fts(rowid, category, remark, description)
+            VALUES (new.id, new.category, new.remark, new.description);
+        END
+        )"
+    };
+}
+
+// 版本 7：bill_ts 为 create_time 按 strftime('%s') 换算的秒数（与 TimestampParser 同一基准），
+// 读取记录时直接取整数，不再逐行解析时间文本。优先用虚拟生成列（SQLite 3.31+），不占存储、
+// 不会与 create_time 不一致；不支持时退回普通列，由触发器在写入 create_time 后回填
+bool SqliteHelper::migrateBillTimestamp() {
+    // PRAGMA table_info 不列出生成列，ensureColumn 无法判断，这里按 table_xinfo 检查
+    QSqlQuery query(connection());
+    if (query.exec("SELECT 1 FROM pragma_table_xinfo('account_record') WHERE name = 'bill_ts'") && query.next()) {
+        return true;
+    }
+    query.finish();
+
+    if (query.exec("ALTER TABLE account_record ADD COLUMN bill_ts INTEGER "
+                   "GENERATED ALWAYS AS (CAST(strftime('%s', create_time) AS INTEGER)) VIRTUAL")) {
+        return true;
+    }
+    qDebug() << "SQLite 不支持生成列，bill_ts 改由触发器维护：" << query.lastError().text();
+    query.finish();
+
+    QStringList stmts = {
+        "ALTER TABLE account_record ADD COLUMN bill_ts INTEGER",
+        "UPDATE account_record SET bill_ts = CAST(strftime('%s', create_time) AS INTEGER)",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_account_record_bill_ts_insert AFTER INSERT ON account_record BEGIN
+            UPDATE account_record SET bill_ts = CAST(strftime('%s', new.create_time) AS INTEGER) WHERE id = new.id;
+        END
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS trg_account_record_bill_ts_update
+        AFTER UPDATE OF create_time ON account_record BEGIN
+            UPDATE account_record SET bill_ts = CAST(strftime('%s', new.create_time) AS INTEGER) WHERE id = new.id;
+        END
+        )"
+    };
+    for (const QString& sql : stmts) {
+        if (!executeSql(sql)) return false;
+    }
+    return true;
+}
+
+// 版本 8：StatisticsManager 的按分类 GROUP BY 除金额外还要读 category，版本 4 的索引不含该列，
+// 每行都要回表；在末尾加上 category 后按日、按分类汇总都只读索引，键集分页的排序不受影响
+bool SqliteHelper::migrateStatisticsIndex() {
+    QStringList stmts = {
+        "CREATE INDEX IF NOT EXISTS idx_account_user_deleted_time_id_cat ON account_record(user_id, is_deleted, create_time, id, amount, category)",
+        "DROP INDEX IF EXISTS idx_account_user_deleted_time_id"
+    };
+    for (const QString& sql : stmts) {
+        if (!executeSql(sql)) return false;
+    }
+    return executeSql("ANALYZE account_record");
+}
+
+// 版本 9：统计、预算与月份抬头不再每次扫描记录，改读按天预先汇总的 daily_rollup
+bool SqliteHelper::migrateDailyRollup() {
+    const QStringList stmts = dailyRollupSchema();
+    for (const QString& sql : stmts) {
+        if (!executeSql(sql)) return false;
+    }
+    // 为已有记录生成汇总
+    return executeSql("DELETE FROM daily_rollup")
+           && executeSql("INSERT INTO daily_rollup(user_id, day, category, type, sum_cents, count) " + dailyRollupScanSql());
+}
+
+// 版本 10：daily_rollup 的每次变化都让该用户的版本号加一。内存中的派生数据（RangeSumIndex）
+// 保存到文件时记下版本号，下次启动时只需比对一行即可判断是否仍与数据库一致
+bool SqliteHelper::migrateRollupRevision() {
+    const QString bump = "INSERT INTO rollup_revision(user_id, revision) VALUES (%1.user_id, 1) "
+                         "ON CONFLICT(user_id) DO UPDATE SET revision = revision + 1;";
+    QStringList stmts = {
+        R"(
+        CREATE TABLE IF NOT EXISTS rollup_revision (
+            user_id INTEGER PRIMARY KEY,
+            revision INTEGER NOT NULL
+        )
+        )",
+        "CREATE TRIGGER IF NOT EXISTS trg_daily_rollup_revision_insert AFTER INSERT ON daily_rollup BEGIN "
+        + bump.arg("new") + " END",
+        "CREATE TRIGGER IF NOT EXISTS trg_daily_rollup_revision_update AFTER UPDATE ON daily_rollup BEGIN "
+        + bump.arg("new") + " END",
+        "CREATE TRIGGER IF NOT EXISTS trg_daily_rollup_revision_delete AFTER DELETE ON daily_rollup BEGIN "
+        + bump.arg("old") + " END",
+        "INSERT OR IGNORE INTO rollup_revision(user_id, revision) SELECT DISTINCT user_id, 1 FROM daily_rollup"
+    };
+    for (const QString& sql : stmts) {
+        if (!executeSql(sql)) return false;
+    }
+    return true;
+}
+
+// 版本 11：每个用户可以有多条预算，按 (分类, 周期) 唯一；分类为空串表示全部支出。
+// 原 budget 表每个用户一行，非零的日、月、年预算迁为三条全部支出的规则
+bool SqliteHelper::migrateBudgetRules() {
+    QStringList stmts = {
+        R"(
+        CREATE TABLE IF NOT EXISTS budget_rule (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            user_id INTEGER NOT NULL,
+            category TEXT NOT NULL DEFAULT '',  -- 分类名称，空串表示全部支出
+            period INTEGER NOT NULL,            -- 0=日 1=月 2=年
+            limit_amount REAL NOT NULL,         -- 限额（元，正数）
+            UNIQUE (user_id, category, period),
+            FOREIGN KEY (user_id) REFERENCES user(id) ON DELETE CASCADE
+        )
+        )",
+        "INSERT OR IGNORE INTO budget_rule(user_id, category, period, limit_amount) "
+        "SELECT user_id, '', 0, daily_budget FROM budget WHERE daily_budget > 0",
+        "INSERT OR IGNORE INTO budget_rule(user_id, category, period, limit_amount) "
+        "SELECT user_id, '', 1, monthly_budget FROM budget WHERE monthly_budget > 0",
+        "INSERT OR IGNORE INTO budget_rule(user_id, category, period, limit_amount) "
+        "SELECT user_id, '', 2, yearly_budget FROM budget WHERE yearly_budget > 0"
+    };
+    for (const QString& sql : stmts) {
+        if (!executeSql(sql)) return false;
+    }
     return true;
 }
 
@@ -232,158 +834,684 @@ bool SqliteHelper::insertDefaultData() {
 }
 
 void SqliteHelper::closeDatabase() {
-    if (m_db.isOpen()) {
-        m_db.close();
+    {
+        QMutexLocker locker(&m_poolMutex);
+        m_initialized = false;
+        m_dbPath.clear();
+    }
+    // 其他线程在下次访问时发现代数变化，自行释放旧连接
+    m_generation.fetchAndAddOrdered(1);
+    if (m_connections.hasLocalData()) {
+        m_connections.localData()->release();
     }
 }
 
+void SqliteHelper::markActivity() {
+    m_lastActivityMs.storeRelaxed(QDateTime::currentMSecsSinceEpoch());
+}
+
+void SqliteHelper::markWrite(const QString& sql) {
+    // PRAGMA、ANALYZE、VACUUM 等维护语句不改动数据，不应让按计数判断的缓存失效
+    if (!isMutatingStatement(sql)) return;
+    m_writeGeneration.fetchAndAddOrdered(1);
+    if (!touchesRecordData(sql)) return;
+    // 事务内的写入在提交或回滚时再递增一次：之前读到旧数据填入缓存的线程据此发现过期
+    ThreadConnection* ctx = threadContext();
+    if (ctx->inTransaction) ctx->recordWriteInTransaction = true;
+    bumpRecordGeneration(ctx);
+}
+
+void SqliteHelper::markDataReplaced() {
+    m_writeGeneration.fetchAndAddOrdered(1);
+    bumpRecordGeneration(threadContext());
+}
+
+void SqliteHelper::markTransactionEnd() {
+    m_writeGeneration.fetchAndAddOrdered(1);
+    ThreadConnection* ctx = threadContext();
+    if (ctx->recordWriteInTransaction && !ctx->inTransaction) {
+        ctx->recordWriteInTransaction = false;
+        bumpRecordGeneration(ctx);
+    }
+}
+
+void SqliteHelper::bumpRecordGeneration(ThreadConnection* ctx) {
+    qint64 previous = m_recordGeneration.fetchAndAddOrdered(1);
+    // 紧接在本线程上一次递增之后则延续区间，否则说明中间有其他线程写入，从这次重新开始
+    if (previous != ctx->ownRecordTo) ctx->ownRecordFrom = previous;
+    ctx->ownRecordTo = previous + 1;
+}
+
+qint64 SqliteHelper::ownRecordGeneration(qint64 generationBefore) {
+    ThreadConnection* ctx = threadContext();
+    if (ctx->ownRecordFrom <= generationBefore && generationBefore < ctx->ownRecordTo) {
+        return ctx->ownRecordTo;
+    }
+    return -1;
+}
+
+bool SqliteHelper::isMutatingStatement(const QString& sql) {
+    // 按首个关键字判断；WITH 可能引出写语句，按写入处理
+    static const QRegularExpression mutating(
+        "^\\s*(INSERT|UPDATE|DELETE|REPLACE|CREATE|DROP|ALTER|WITH)\\b",
+        QRegularExpression::CaseInsensitiveOption);
+    return mutating.match(sql).hasMatch();
+}
+
+bool SqliteHelper::touchesRecordData(const QString& sql) {
+    // 删除用户会级联删除其账单；用户表的其他写入（登录计数、资料修改）不影响账单数据
+    static const QRegularExpression deleteUser("\\bDELETE\\s+FROM\\s+user\\b",
+                                               QRegularExpression::CaseInsensitiveOption);
+    return sql.contains("account_record", Qt::CaseInsensitive)
+           || sql.contains("daily_rollup", Qt::CaseInsensitive)
+           || deleteUser.match(sql).hasMatch();
+}
+
+qint64 SqliteHelper::writeGeneration() const {
+    return m_writeGeneration.loadAcquire();
+}
+
+qint64 SqliteHelper::recordGeneration() const {
+    return m_recordGeneration.loadAcquire();
+}
+
+qint64 SqliteHelper::idleMsecs() const {
+    return QDateTime::currentMSecsSinceEpoch() - m_lastActivityMs.loadRelaxed();
+}
+
 bool SqliteHelper::executeSql(const QString& sql) {
-    QSqlQuery query(m_db);
-    if (!query.exec(sql)) {
-        m_lastError = "SQL执行失败：" + sql + " 错误：" + query.lastError().text();
-        qDebug() << m_lastError;
+    markActivity();
+    QSqlQuery query(connection());
+    bool ok = query.exec(sql);
+    markWrite(sql);
+    if (!ok) {
+        setLastError("SQL执行失败：" + sql + " 错误：" + query.lastError().text());
+        qDebug() << getLastError();
         return false;
     }
     return true;
 }
 
 bool SqliteHelper::executeSqlWithParams(const QString& sql, const QVariantList& params) {
-    QSqlQuery query(m_db);
-    query.prepare(sql);
-    for (const QVariant& param : params) {
-        query.addBindValue(param);
-    }
-    if (!query.exec()) {
-        m_lastError = "参数化SQL执行失败：" + sql + " 错误：" + query.lastError().text();
-        qDebug() << m_lastError;
+    markActivity();
+    CachedQuery statement;
+    if (!acquireStatement(sql, statement)) {
         return false;
     }
-    return true;
+    QSqlQuery& query = statement.query();
+    for (int i = 0; i < params.size(); ++i) {
+        query.bindValue(i, params.at(i));
+    }
+    bool ok = query.exec();
+    markWrite(sql);
+    if (!ok) {
+        setLastError("参数化SQL执行失败：" + sql + " 错误：" + query.lastError().text());
+        qDebug() << getLastError();
+    }
+    return ok;
 }
 
 QSqlQuery SqliteHelper::executeQuery(const QString& sql) {
-    QMutexLocker locker(&m_mutex);  // 线程安全
-    QSqlQuery query(m_db);
+    markActivity();
+    QSqlQuery query(connection());
     if (!query.exec(sql)) {
-        m_lastError = "SQL查询失败：" + sql + " 错误：" + query.lastError().text();
-        qDebug() << m_lastError;
+        setLastError("SQL查询失败：" + sql + " 错误：" + query.lastError().text());
+        qDebug() << getLastError();
     }
     return query;
 }
 
-QSqlQuery SqliteHelper::executeQueryWithParams(const QString& sql, const QVariantList& params) {
-    QSqlQuery query(m_db);
-    query.prepare(sql);
-    for (const QVariant& param : params) {
-        query.addBindValue(param);
+SqliteHelper::CachedQuery SqliteHelper::executeQueryWithParams(const QString& sql, const QVariantList& params) {
+    markActivity();
+    CachedQuery statement;
+    if (!acquireStatement(sql, statement)) {
+        return statement;
+    }
+    QSqlQuery& query = statement.query();
+    for (int i = 0; i < params.size(); ++i) {
+        query.bindValue(i, params.at(i));
     }
     if (!query.exec()) {
-        m_lastError = "参数化SQL查询失败：" + sql + " 错误：" + query.lastError().text();
-        qDebug() << m_lastError;
+        setLastError("参数化SQL查询失败：" + sql + " 错误：" + query.lastError().text());
+        qDebug() << getLastError();
     }
-    return query;
+    return statement;
 }
 
-QSqlDatabase SqliteHelper::getDatabase() {
-    return m_db;
+// ============ 预编译语句缓存 ============
+SqliteHelper::CachedQuery::CachedQuery() : m_query(std::make_unique<QSqlQuery>()) {}
+
+SqliteHelper::CachedQuery::CachedQuery(CachedQuery&& other) noexcept
+    : m_query(std::move(other.m_query)), m_owner(other.m_owner),
+      m_sql(std::move(other.m_sql)), m_connectionName(std::move(other.m_connectionName)) {
+    other.m_owner = nullptr;
 }
 
-// ============ 事务管理 ============
-bool SqliteHelper::beginTransaction() {
-    if (!m_db.transaction()) {
-        m_lastError = "开启事务失败：" + m_db.lastError().text();
-        qDebug() << m_lastError;
-        return false;
+SqliteHelper::CachedQuery& SqliteHelper::CachedQuery::operator=(CachedQuery&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_query = std::move(other.m_query);
+        m_owner = other.m_owner;
+        m_sql = std::move(other.m_sql);
+        m_connectionName = std::move(other.m_connectionName);
+        other.m_owner = nullptr;
     }
-    return true;
+    return *this;
 }
 
-bool SqliteHelper::commitTransaction() {
-    if (!m_db.commit()) {
-        m_lastError = "提交事务失败：" + m_db.lastError().text();
-        qDebug() << m_lastError;
-        return false;
+SqliteHelper::CachedQuery::~CachedQuery() {
+    release();
+}
+
+void SqliteHelper::CachedQuery::release() {
+    if (m_query && m_owner) {
+        m_owner->releaseStatement(*this);
     }
-    return true;
+    m_query.reset();
+    m_owner = nullptr;
 }
 
-bool SqliteHelper::rollbackTransaction() {
-    if (!m_db.rollback()) {
-        m_lastError = "回滚事务失败：" + m_db.lastError().text();
-        qDebug() << m_lastError;
-        return false;
+bool SqliteHelper::acquireStatement(const QString& sql, CachedQuery& statement) {
+    // 先取连接：连接失效重建时会清空旧缓存
+    QSqlDatabase db = connection();
+    ThreadConnection* ctx = threadContext();
+    statement = CachedQuery();
+
+    // 借出期间语句不在缓存中，不会被其他调用方重新绑定而破坏对方的游标
+    auto it = ctx->statements.find(sql);
+    if (it != ctx->statements.end()) {
+        m_statementHits.fetchAndAddRelaxed(1);
+        statement.m_query = std::move(it->second);
+        ctx->statements.erase(it);
+        ctx->statementLru.removeOne(sql);
+    } else {
+        m_statementMisses.fetchAndAddRelaxed(1);
+        statement.m_query = std::make_unique<QSqlQuery>(db);
+        statement.m_query->setForwardOnly(true);
+        if (!statement.m_query->prepare(sql)) {
+            setLastError("SQL预编译失败：" + sql + " 错误：" + statement.m_query->lastError().text());
+            qDebug() << getLastError();
+            return false;
+        }
+    }
+
+    if (m_statementCacheCapacity.loadRelaxed() > 0) {
+        statement.m_owner = this;
+        statement.m_sql = sql;
+        statement.m_connectionName = ctx->name;
     }
     return true;
 }
 
-// ============ 数据库备份与恢复 ============
-bool SqliteHelper::createBackup(const QString& backupDir) {
-    QFile dbFile(m_dbPath);
-    if (!dbFile.exists()) {
-        m_lastError = "数据库文件不存在：" + m_dbPath;
-        qDebug() << m_lastError;
+void SqliteHelper::releaseStatement(CachedQuery& statement) {
+    statement.m_query->finish();
+    int capacity = m_statementCacheCapacity.loadRelaxed();
+    if (capacity <= 0 || !m_connections.hasLocalData()) return;
+
+    ThreadConnection* ctx = m_connections.localData();
+    // 连接已重建的旧语句、或借出期间同一 SQL 已另有空闲语句时直接丢弃
+    if (ctx->name.isEmpty() || ctx->name != statement.m_connectionName
+        || ctx->statements.count(statement.m_sql) > 0) {
+        return;
+    }
+    ctx->statements.emplace(statement.m_sql, std::move(statement.m_query));
+    ctx->touchStatement(statement.m_sql);
+    int evicted = ctx->trimStatements(capacity);
+    if (evicted > 0) {
+        m_statementEvictions.fetchAndAddRelaxed(evicted);
+    }
+}
+
+void SqliteHelper::setStatementCacheCapacity(int capacity) {
+    m_statementCacheCapacity.storeRelaxed(qMax(0, capacity));
+    // 其他线程的缓存在下次插入时按新容量收缩
+    if (m_connections.hasLocalData()) {
+        int evicted = m_connections.localData()->trimStatements(qMax(0, capacity));
+        m_statementEvictions.fetchAndAddRelaxed(evicted);
+    }
+}
+
+void SqliteHelper::clearStatementCache() {
+    if (m_connections.hasLocalData()) {
+        m_connections.localData()->clearStatements();
+    }
+}
+
+SqliteHelper::StatementCacheStats SqliteHelper::getStatementCacheStats() {
+    StatementCacheStats stats;
+    stats.hits = m_statementHits.loadRelaxed();
+    stats.misses = m_statementMisses.loadRelaxed();
+    stats.evictions = m_statementEvictions.loadRelaxed();
+    stats.capacity = m_statementCacheCapacity.loadRelaxed();
+    if (m_connections.hasLocalData()) {
+        stats.cachedStatements = int(m_connections.localData()->statements.size());
+    }
+    return stats;
+}
+
+void SqliteHelper::resetStatementCacheStats() {
+    m_statementHits.storeRelaxed(0);
+    m_statementMisses.storeRelaxed(0);
+    m_statementEvictions.storeRelaxed(0);
+}
+
+// ============ 异步执行 ============
+QThreadPool* SqliteHelper::dbThreadPool() {
+    QMutexLocker locker(&m_poolMutex);
+    if (!m_dbPool) {
+        m_dbPool = new QThreadPool();
+        // SQLite 同一时刻只有一个写者，少量常驻线程即可；不回收线程以免反复建连
+        m_dbPool->setMaxThreadCount(2);
+        m_dbPool->setExpiryTimeout(-1);
+    }
+    return m_dbPool;
+}
+
+// ============ 批量写入 ============
+SqliteHelper::BulkWriteResult SqliteHelper::bulkInsert(const QString& table, const QStringList& columns,
+                                                       const QList<QVariantList>& columnValues, int chunkSize) {
+    QStringList placeholders;
+    for (int i = 0; i < columns.size(); ++i) {
+        placeholders << "?";
+    }
+    QString sql = QString("INSERT INTO %1 (%2) VALUES (%3)")
+                      .arg(table, columns.join(", "), placeholders.join(", "));
+    return bulkWrite(table, sql, columns, columnValues, chunkSize, BulkMode::Insert);
+}
+
+SqliteHelper::BulkWriteResult SqliteHelper::bulkUpsert(const QString& table, const QStringList& columns,
+                                                       const QList<QVariantList>& columnValues,
+                                                       const QStringList& conflictColumns, int chunkSize) {
+    QStringList placeholders;
+    QStringList updates;
+    for (const QString& column : columns) {
+        placeholders << "?";
+        if (!conflictColumns.contains(column, Qt::CaseInsensitive)) {
+            updates << QString("%1 = excluded.%1").arg(column);
+        }
+    }
+    QString conflict = updates.isEmpty() ? QString("DO NOTHING") : "DO UPDATE SET " + updates.join(", ");
+    QString sql = QString("INSERT INTO %1 (%2) VALUES (%3) ON CONFLICT(%4) %5")
+                      .arg(table, columns.join(", "), placeholders.join(", "),
+                           conflictColumns.join(", "), conflict);
+    return bulkWrite(table, sql, columns, columnValues, chunkSize, BulkMode::Upsert, conflictColumns);
+}
+
+SqliteHelper::BulkWriteResult SqliteHelper::bulkInsertReturning(const QString& table, const QStringList& columns,
+                                                                const QList<QVariantList>& columnValues, int chunkSize) {
+    QStringList placeholders;
+    for (int i = 0; i < columns.size(); ++i) {
+        placeholders << "?";
+    }
+    QString sql = QString("INSERT INTO %1 (%2) VALUES (%3) RETURNING rowid")
+                      .arg(table, columns.join(", "), placeholders.join(", "));
+    return bulkWrite(table, sql, columns, columnValues, chunkSize, BulkMode::InsertReturning);
+}
+
+// 插入触发器逐行维护 daily_rollup 和 FTS5 索引，大批量导入时这部分开销远大于插入本身。
+// 删除触发器与补齐、重建在同一事务内完成，其他连接看不到触发器缺失的中间状态
+SqliteHelper::BulkWriteResult SqliteHelper::importAccountRecords(const QStringList& columns,
+                                                                 const QList<QVariantList>& columnValues) {
+    BulkWriteResult result;
+    QStringList triggers;
+    for (const QString& sql : dailyRollupSchema()) {
+        if (sql.contains("trg_account_record_rollup_insert")) triggers << sql;
+    }
+    bool fullText = hasFullTextIndex();
+    if (fullText) {
+        for (const QString& sql : fullTextIndexSchema()) {
+            if (sql.contains("trg_account_record_fts_insert")) triggers << sql;
+        }
+    }
+
+    ScopedDurabilityProfile bulkProfile(this, "bulk-import");
+    bool ownTransaction = !threadContext()->inTransaction;
+    if (ownTransaction && !beginTransaction()) {
+        return result;
+    }
+    bool ok = executeSql("DROP TRIGGER IF EXISTS trg_account_record_rollup_insert");
+    if (ok && fullText) {
+        ok = executeSql("DROP TRIGGER IF EXISTS trg_account_record_fts_insert");
+    }
+    if (ok) {
+        result = bulkInsert("account_record", columns, columnValues, 0);
+        ok = result.success;
+    }
+    if (ok && !result.rowIds.isEmpty()) {
+        // 本批行 ID 为连续区间（bulkInsert 已核对），按区间补齐，语义与触发器逐行维护一致
+        QVariantList range = {result.rowIds.first(), result.rowIds.last()};
+        ok = executeSqlWithParams(
+            "INSERT INTO daily_rollup(user_id, day, category, type, sum_cents, count) "
+            + dailyRollupScanSql("id BETWEEN ? AND ?")
+            + " ON CONFLICT(user_id, day, category, type) "
+              "DO UPDATE SET sum_cents = sum_cents + excluded.sum_cents, count = count + excluded.count",
+            range);
+        if (ok && fullText) {
+            ok = executeSqlWithParams(
+                "INSERT INTO account_record_fts(rowid, category, remark, description) "
+                "SELECT id, category, remark, description FROM account_record WHERE id BETWEEN ? AND ?",
+                range);
+        }
+    }
+    // 无论成败都恢复触发器：并入调用方事务时，调用方可能在失败后继续使用这个事务
+    for (const QString& sql : triggers) {
+        ok = executeSql(sql) && ok;
+    }
+    if (ok && ownTransaction) {
+        ok = commitTransaction();
+    }
+    if (!ok) {
+        if (ownTransaction) rollbackTransaction();
+        result.success = false;
+        result.rowsWritten = 0;
+        result.rowIds.clear();
+    }
+    return result;
+}
+
+SqliteHelper::BulkWriteResult SqliteHelper::bulkWrite(const QString& table, const QString& sql,
+                                                      const QStringList& columns,
+                                                      const QList<QVariantList>& columnValues,
+                                                      int chunkSize, BulkMode mode,
+                                                      const QStringList& keyColumns) {
+    BulkWriteResult result;
+    if (columns.isEmpty() || columns.size() != columnValues.size()) {
+        setLastError("批量写入参数错误：列名与列数据数量不一致");
+        qDebug() << getLastError();
+        return result;
+    }
+    int rowCount = columnValues.first().size();
+    for (const QVariantList& values : columnValues) {
+        if (values.size() != rowCount) {
+            setLastError("批量写入参数错误：各列数据行数不一致");
+            qDebug() << getLastError();
+            return result;
+        }
+    }
+    if (rowCount == 0) {
+        result.success = true;
+        return result;
+    }
+    markActivity();
+
+    CachedQuery statement;
+    if (!acquireStatement(sql, statement)) {
+        return result;
+    }
+    QSqlQuery& query = statement.query();
+
+    bool ownTransaction = !threadContext()->inTransaction;
+    int step = (ownTransaction && chunkSize > 0) ? chunkSize : rowCount;
+
+    for (int offset = 0; offset < rowCount; offset += step) {
+        int count = qMin(step, rowCount - offset);
+        if (ownTransaction && !beginTransaction()) {
+            break;
+        }
+
+        QList<qint64> chunkIds;
+        bool ok = true;
+        QString error;
+        if (mode == BulkMode::InsertReturning) {
+            for (int row = offset; row < offset + count && ok; ++row) {
+                for (int c = 0; c < columnValues.size(); ++c) {
+                    query.bindValue(c, columnValues.at(c).at(row));
+                }
+                ok = query.exec() && query.next();
+                if (ok) {
+                    chunkIds << query.value(0).toLongLong();
+                    // RETURNING 语句读出一行后仍在执行中，须先结束，否则提交时报 SQL statements in progress
+                    query.finish();
+                }
+            }
+            if (!ok) error = query.lastError().text();
+        } else {
+            // 事务内先读当前最大 rowid：WAL 下读快照已过期时后续写入会直接失败，
+            // 写入成功则从读到写之间没有其他连接插入，之后的新行全部来自本块
+            qint64 maxRowIdBefore = 0;
+            if (mode == BulkMode::Insert) {
+                CachedQuery maxQuery = executeQueryWithParams(
+                    QString("SELECT COALESCE(MAX(rowid), 0) FROM %1").arg(table), {});
+                ok = maxQuery.next();
+                if (ok) maxRowIdBefore = maxQuery.value(0).toLongLong();
+                else error = maxQuery.lastError().text();
+                maxQuery.finish();
+            }
+            if (ok) {
+                for (int c = 0; c < columnValues.size(); ++c) {
+                    query.bindValue(c, columnValues.at(c).mid(offset, count));
+                }
+                ok = query.execBatch();
+                if (!ok) error = query.lastError().text();
+            }
+            if (ok) {
+                ok = (mode == BulkMode::Insert)
+                         ? collectInsertedIds(table, columns, columnValues, offset, count, maxRowIdBefore, chunkIds)
+                         : collectKeyIds(table, columns, columnValues, keyColumns, offset, count, chunkIds);
+                if (!ok) error = getLastError();
+            }
+        }
+
+        markWrite(sql);
+        if (!ok) {
+            setLastError("批量写入失败：" + sql + " 错误：" + error);
+            qDebug() << getLastError();
+        }
+        if (ok && ownTransaction) {
+            ok = commitTransaction();
+        }
+        if (!ok) {
+            if (ownTransaction) rollbackTransaction();
+            query.finish();
+            return result;
+        }
+
+        result.rowsWritten += count;
+        result.rowIds += chunkIds;
+    }
+
+    query.finish();
+    result.success = result.rowsWritten == rowCount;
+    return result;
+}
+
+bool SqliteHelper::collectInsertedIds(const QString& table, const QStringList& columns,
+                                      const QList<QVariantList>& columnValues, int offset, int count,
+                                      qint64 maxRowIdBefore, QList<qint64>& ids) {
+    // 显式提供了 id 时直接使用
+    for (int c = 0; c < columns.size(); ++c) {
+        if (columns.at(c).compare("id", Qt::CaseInsensitive) != 0) continue;
+        for (int row = offset; row < offset + count; ++row) {
+            QVariant id = columnValues.at(c).at(row);
+            if (id.isNull()) {
+                ids.clear();
+                break;
+            }
+            ids << id.toLongLong();
+        }
+        if (ids.size() == count) return true;
+    }
+
+    // 同一事务内写锁独占，execBatch 按输入顺序逐行插入，新行的 rowid 递增；
+    // 不假定区间从 maxRowIdBefore + 1 开始（AUTOINCREMENT 不复用已删除的最大行号），只核对区间连续且恰好 count 行
+    CachedQuery query = executeQueryWithParams(
+        QString("SELECT COUNT(*), MIN(rowid), MAX(rowid) FROM %1 WHERE rowid > ?").arg(table), {maxRowIdBefore});
+    if (!query.next()) {
+        setLastError("读取批量插入的行 ID 失败：" + query.lastError().text());
         return false;
     }
+    qint64 rows = query.value(0).toLongLong();
+    qint64 first = query.value(1).toLongLong();
+    qint64 last = query.value(2).toLongLong();
+    query.finish();
+    if (rows != count || last - first + 1 != count) {
+        setLastError(QString("批量插入的行 ID 不连续：新增 %1 行，区间 [%2, %3]，期望 %4 行")
+                         .arg(rows).arg(first).arg(last).arg(count));
+        return false;
+    }
+    for (qint64 id = first; id <= last; ++id) {
+        ids << id;
+    }
+    return true;
+}
 
-    QDir dir(backupDir);
-    if (!dir.exists()) {
-        if (!dir.mkpath(backupDir)) {
-            m_lastError = "无法创建备份目录：" + backupDir;
-            qDebug() << m_lastError;
+bool SqliteHelper::collectKeyIds(const QString& table, const QStringList& columns,
+                                 const QList<QVariantList>& columnValues, const QStringList& keyColumns,
+                                 int offset, int count, QList<qint64>& ids) {
+    QList<int> keyIndexes;
+    QStringList conditions;
+    for (const QString& key : keyColumns) {
+        int index = -1;
+        for (int c = 0; c < columns.size(); ++c) {
+            if (columns.at(c).compare(key, Qt::CaseInsensitive) == 0) index = c;
+        }
+        if (index < 0) {
+            setLastError("批量写入参数错误：冲突列 " + key + " 不在写入列中");
             return false;
         }
+        keyIndexes << index;
+        conditions << key + " = ?";
     }
+    const QString sql = QString("SELECT rowid FROM %1 WHERE %2").arg(table, conditions.join(" AND "));
+    for (int row = offset; row < offset + count; ++row) {
+        QVariantList params;
+        for (int index : keyIndexes) {
+            params << columnValues.at(index).at(row);
+        }
+        CachedQuery query = executeQueryWithParams(sql, params);
+        if (!query.next()) {
+            setLastError(QString("按冲突列查回第 %1 行的行 ID 失败").arg(row + 1));
+            return false;
+        }
+        ids << query.value(0).toLongLong();
+        query.finish();
+    }
+    return true;
+}
 
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd_HH-mm-ss");
-    QString backupFileName = "account_book_" + timestamp + ".db";
-    QString backupFilePath = backupDir + "/" + backupFileName;
+QString SqliteHelper::databasePath() {
+    QMutexLocker locker(&m_poolMutex);
+    return m_dbPath;
+}
+
+QSqlDatabase SqliteHelper::getDatabase() {
+    return connection();
+}
 
-    if (!QFile::copy(m_dbPath, backupFilePath)) {
-        m_lastError = "备份失败：无法复制数据库文件";
-        qDebug() << m_lastError;
+bool SqliteHelper::setDurabilityProfile(const QString& profileName) {
+    bool ok = false;
+    DurabilityProfile profile = DurabilityProfile::byName(profileName, &ok);
+    if (!ok) {
+        setLastError("未知的持久化配置档：" + profileName);
+        qDebug() << getLastError();
         return false;
     }
+    {
+        QMutexLocker locker(&m_poolMutex);
+        m_profile = profile;
+    }
+    m_profileGeneration.fetchAndAddOrdered(1);
 
-    qDebug() << "备份成功：" << backupFilePath;
+    // 触发当前线程连接重新应用配置（事务中则推迟到事务结束后）
+    connection();
+    qDebug() << "切换持久化配置：" << getEffectiveSettings();
+    return true;
+}
 
-    // 清理过期备份（仅保留最近10个）
-    QStringList backups = listBackups(backupDir);
-    if (backups.size() > 10) {
-        for (int i = 0; i < backups.size() - 10; ++i) {
-            deleteBackup(backupDir + "/" + backups[i]);
+SqliteHelper::DurabilityProfile SqliteHelper::getDurabilityProfile() {
+    QMutexLocker locker(&m_poolMutex);
+    return m_profile;
+}
+
+SqliteHelper::ScopedDurabilityProfile::ScopedDurabilityProfile(SqliteHelper* helper, const QString& profileName)
+    : m_helper(helper) {
+    // 事务中切换不会立即生效，调用方已开启事务时保持原配置档
+    if (profileName.isEmpty() || m_helper->threadContext()->inTransaction) return;
+    QString current = m_helper->getDurabilityProfile().name;
+    if (current != profileName && m_helper->setDurabilityProfile(profileName)) {
+        m_previous = current;
+    }
+}
+
+SqliteHelper::ScopedDurabilityProfile::~ScopedDurabilityProfile() {
+    if (!m_previous.isEmpty()) {
+        m_helper->setDurabilityProfile(m_previous);
+    }
+}
+
+QString SqliteHelper::getEffectiveSettings() {
+    QSqlQuery query(connection());
+    QStringList settings;
+    settings << "profile=" + getDurabilityProfile().name;
+
+    const QStringList pragmas = {"journal_mode", "synchronous", "mmap_size", "cache_size",
+                                 "temp_store", "wal_autocheckpoint", "foreign_keys"};
+    for (const QString& pragma : pragmas) {
+        if (query.exec("PRAGMA " + pragma) && query.next()) {
+            settings << pragma + "=" + query.value(0).toString();
         }
     }
+    return settings.join(", ");
+}
 
+// ============ 事务管理 ============
+bool SqliteHelper::beginTransaction() {
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        setLastError("开启事务失败：" + db.lastError().text());
+        qDebug() << getLastError();
+        return false;
+    }
+    threadContext()->inTransaction = true;
     return true;
 }
 
-bool SqliteHelper::restoreBackup(const QString& backupFilePath) {
-    QFile backupFile(backupFilePath);
-    if (!backupFile.exists()) {
-        m_lastError = "备份文件不存在：" + backupFilePath;
-        qDebug() << m_lastError;
+bool SqliteHelper::commitTransaction() {
+    QSqlDatabase db = connection();
+    bool committed = db.commit();
+    if (!committed) {
+        markTransactionEnd();
+        setLastError("提交事务失败：" + db.lastError().text());
+        qDebug() << getLastError();
         return false;
     }
+    threadContext()->inTransaction = false;
+    markTransactionEnd();
+    return true;
+}
 
-    closeDatabase();
-
-    QFile targetFile(m_dbPath);
-    if (targetFile.exists()) {
-        if (!targetFile.remove()) {
-            m_lastError = "无法删除旧数据库文件";
-            qDebug() << m_lastError;
-            return false;
-        }
+bool SqliteHelper::rollbackTransaction() {
+    QSqlDatabase db = connection();
+    threadContext()->inTransaction = false;
+    bool rolledBack = db.rollback();
+    markTransactionEnd();
+    if (!rolledBack) {
+        setLastError("回滚事务失败：" + db.lastError().text());
+        qDebug() << getLastError();
+        return false;
     }
+    return true;
+}
 
-    if (!QFile::copy(backupFilePath, m_dbPath)) {
-        m_lastError = "恢复失败：无法复制备份文件";
-        qDebug() << m_lastError;
+// ============ 数据库备份与恢复 ============
+bool SqliteHelper::createBackup(const QString& backupDir) {
+    // 逐页复制或 VACUUM INTO（见 SqliteBackup），复制期间不阻塞其他连接的读写，也不会得到写了一半的副本
+    SqliteBackup engine;
+    if (!engine.backup(backupDir, 10)) {
+        setLastError(engine.lastError());
         return false;
     }
+    return true;
+}
 
-    // 重新打开数据库
-    return openDatabase(m_dbPath);
+bool SqliteHelper::restoreBackup(const QString& backupFilePath) {
+    // 把备份写回正在使用的数据库（逐页或逐表，见 SqliteBackup），其他线程的连接无需重建
+    SqliteBackup engine;
+    if (!engine.restore(backupFilePath)) {
+        setLastError(engine.lastError());
+        return false;
+    }
+    return true;
 }
 
 QStringList SqliteHelper::listBackups(const QString& backupDir) {
@@ -408,13 +1536,13 @@ QStringList SqliteHelper::listBackups(const QString& backupDir) {
 bool SqliteHelper::deleteBackup(const QString& backupFilePath) {
     QFile file(backupFilePath);
     if (!file.exists()) {
-        m_lastError = "备份文件不存在：" + backupFilePath;
+        setLastError("备份文件不存在：" + backupFilePath);
         return false;
     }
 
     if (!file.remove()) {
-        m_lastError = "删除备份文件失败：" + backupFilePath;
-        qDebug() << m_lastError;
+        setLastError("删除备份文件失败：" + backupFilePath);
+        qDebug() << getLastError();
         return false;
     }
 
@@ -424,15 +1552,20 @@ bool SqliteHelper::deleteBackup(const QString& backupFilePath) {
 
 // ============ 数据库维护与优化 ============
 bool SqliteHelper::optimizeDatabase() {
-    // VACUUM操作重新整理数据库文件
-    if (!executeSql("VACUUM")) {
-        m_lastError = "数据库优化失败";
+    // 整库 VACUUM 会重写文件并阻塞所有写入，这里只回收空闲页（需 auto_vacuum = INCREMENTAL）
+    QSqlQuery query(connection());
+    if (!query.exec("PRAGMA incremental_vacuum")) {
+        setLastError("数据库空间回收失败：" + query.lastError().text());
+        qDebug() << getLastError();
         return false;
     }
+    // incremental_vacuum 每步回收一页，需要一直步进到结束
+    while (query.next()) {}
 
-    // ANALYZE操作更新统计信息以优化查询
-    if (!executeSql("ANALYZE")) {
-        m_lastError = "数据库分析失败";
+    // PRAGMA optimize 只对统计信息过期的表执行 ANALYZE
+    if (!query.exec("PRAGMA optimize")) {
+        setLastError("数据库分析失败：" + query.lastError().text());
+        qDebug() << getLastError();
         return false;
     }
 
@@ -440,6 +1573,33 @@ bool SqliteHelper::optimizeDatabase() {
     return true;
 }
 
+SqliteHelper::SpaceMetrics SqliteHelper::getSpaceMetrics() {
+    SpaceMetrics metrics;
+    QSqlQuery query(connection());
+    auto pragmaValue = [&query](const QString& pragma) -> qint64 {
+        if (query.exec("PRAGMA " + pragma) && query.next()) {
+            return query.value(0).toLongLong();
+        }
+        return 0;
+    };
+    metrics.pageSize = static_cast<int>(pragmaValue("page_size"));
+    metrics.pageCount = pragmaValue("page_count");
+    metrics.freelistCount = pragmaValue("freelist_count");
+    metrics.autoVacuum = static_cast<int>(pragmaValue("auto_vacuum"));
+    metrics.fragmentation = metrics.pageCount > 0
+                                ? static_cast<double>(metrics.freelistCount) / metrics.pageCount
+                                : 0;
+
+    QString dbPath;
+    {
+        QMutexLocker locker(&m_poolMutex);
+        dbPath = m_dbPath;
+    }
+    QFileInfo walFile(dbPath + "-wal");
+    metrics.walSizeBytes = walFile.exists() ? walFile.size() : 0;
+    return metrics;
+}
+
 bool SqliteHelper::checkIntegrity() {
     QString sql = "PRAGMA integrity_check";
     QSqlQuery query = executeQuery(sql);
@@ -450,8 +1610,8 @@ bool SqliteHelper::checkIntegrity() {
             qDebug() << "数据库完整性检查通过";
             return true;
         } else {
-            m_lastError = "数据库完整性检查失败：" + result;
-            qDebug() << m_lastError;
+            setLastError("数据库完整性检查失败：" + result);
+            qDebug() << getLastError();
             return false;
         }
     }
@@ -466,76 +1626,77 @@ bool SqliteHelper::enableForeignKeys() {
 bool SqliteHelper::fixOrphanedRecords() {
     QString sql = "DELETE FROM account_record WHERE user_id NOT IN (SELECT id FROM user)";
     if (!executeSql(sql)) {
-        m_lastError = "删除孤立记录失败";
+        setLastError("删除孤立记录失败");
         return false;
     }
     qDebug() << "孤立记录清理完成";
     return true;
 }
 
-QString SqliteHelper::getDatabaseStatistics() {
-    QString stats;
-
-    // 获取数据库文件大小
-    QFile dbFile(m_dbPath);
-    if (dbFile.exists()) {
-        int dbSize = dbFile.size();
-        stats += QString("数据库大小：%1 KB\n").arg(dbSize / 1024);
-    }
-
-    // 获取用户统计
-    QString sql = "SELECT COUNT(*) as count FROM user";
-    QSqlQuery query = executeQuery(sql);
-    if (query.next()) {
-        stats += QString("用户总数：%1\n").arg(query.value("count").toInt());
-    }
-
-    // 获取记录统计
-    sql = "SELECT COUNT(*) as count FROM account_record WHERE is_deleted = 0";
-    query = executeQuery(sql);
-    if (query.next()) {
-        stats += QString("有效记录：%1\n").arg(query.value("count").toInt());
+SqliteHelper::DatabaseStatistics SqliteHelper::getDatabaseStatistics() {
+    // 先记下写入计数再查询：查询期间若有写入，缓存会被视为过期
+    qint64 generation = m_writeGeneration.loadAcquire();
+    {
+        QMutexLocker locker(&m_statsMutex);
+        if (m_statsGeneration == generation) {
+            return m_statsCache;
+        }
     }
 
-    // 获取已删除记录统计
-    sql = "SELECT COUNT(*) as count FROM account_record WHERE is_deleted = 1";
-    query = executeQuery(sql);
-    if (query.next()) {
-        stats += QString("已删除记录：%1\n").arg(query.value("count").toInt());
-    }
+    // 一次扫描 account_record 得到全部计数与合计，页信息通过表值 PRAGMA 函数一并取回
+    QString sql = R"(
+        SELECT
+            (SELECT COUNT(*) FROM user),
+            COALESCE(SUM(is_deleted = 0), 0),
+            COALESCE(SUM(is_deleted = 1), 0),
+            COALESCE(SUM(CASE WHEN is_deleted = 0 AND amount >= 0 THEN amount END), 0),
+            COALESCE(SUM(CASE WHEN is_deleted = 0 AND amount < 0 THEN -amount END), 0),
+            (SELECT page_count FROM pragma_page_count()),
+            (SELECT freelist_count FROM pragma_freelist_count()),
+            (SELECT page_size FROM pragma_page_size())
+        FROM account_record
+    )";
 
-    // 获取总收入
-    sql = "SELECT SUM(amount) as total FROM account_record WHERE is_income = 1 AND is_deleted = 0";
-    query = executeQuery(sql);
-    if (query.next()) {
-        double total = query.value("total").toDouble();
-        stats += QString("总收入：%.2f\n").arg(total);
+    DatabaseStatistics stats;
+    QSqlQuery query(connection());
+    if (!query.exec(sql) || !query.next()) {
+        setLastError("统计查询失败：" + query.lastError().text());
+        qDebug() << getLastError();
+        return stats;
     }
-
-    // 获取总支出
-    sql = "SELECT SUM(amount) as total FROM account_record WHERE is_income = 0 AND is_deleted = 0";
-    query = executeQuery(sql);
-    if (query.next()) {
-        double total = query.value("total").toDouble();
-        stats += QString("总支出：%.2f\n").arg(total);
-    }
-
+    stats.userCount = query.value(0).toLongLong();
+    stats.liveRecordCount = query.value(1).toLongLong();
+    stats.deletedRecordCount = query.value(2).toLongLong();
+    stats.totalIncome = query.value(3).toDouble();
+    stats.totalExpense = query.value(4).toDouble();
+    stats.pageCount = query.value(5).toLongLong();
+    stats.freelistCount = query.value(6).toLongLong();
+    stats.pageSize = query.value(7).toInt();
+    stats.computedAt = QDateTime::currentDateTime();
+
+    QMutexLocker locker(&m_statsMutex);
+    m_statsCache = stats;
+    m_statsGeneration = generation;
     return stats;
 }
 
+QJsonObject SqliteHelper::DatabaseStatistics::toJson() const {
+    QJsonObject json;
+    json["userCount"] = userCount;
+    json["liveRecordCount"] = liveRecordCount;
+    json["deletedRecordCount"] = deletedRecordCount;
+    json["totalIncome"] = totalIncome;
+    json["totalExpense"] = totalExpense;
+    json["pageCount"] = pageCount;
+    json["freelistCount"] = freelistCount;
+    json["pageSize"] = pageSize;
+    json["computedAt"] = computedAt.toString("yyyy-MM-dd HH:mm:ss");
+    return json;
+}
+
 // ============ 版本管理 ============
 bool SqliteHelper::initializeVersion() {
-    createVersionTable();
-
-    QString sql = "SELECT version FROM db_version LIMIT 1";
-    QSqlQuery query = executeQuery(sql);
-
-    if (!query.next()) {
-        QString insertVersion = "INSERT INTO db_version (version, migrate_time) VALUES (1, datetime('now'))";
-        return executeSql(insertVersion);
-    }
-
-    return true;
+    return runMigrations(getCurrentVersion());
 }
 
 bool SqliteHelper::createVersionTable() {
@@ -551,13 +1712,11 @@ bool SqliteHelper::createVersionTable() {
 }
 
 int SqliteHelper::getCurrentVersion() {
-    QString sql = "SELECT version FROM db_version ORDER BY id DESC LIMIT 1";
-    QSqlQuery query = executeQuery(sql);
-
-    if (query.next()) {
-        return query.value("version").toInt();
+    // 新库还没有版本表，查询失败视为版本 0，不记录错误
+    QSqlQuery query(connection());
+    if (query.exec("SELECT version FROM db_version ORDER BY id DESC LIMIT 1") && query.next()) {
+        return query.value(0).toInt();
     }
-
     return 0;
 }
 
@@ -569,13 +1728,186 @@ bool SqliteHelper::setVersion(int version) {
     return executeSqlWithParams(sql, params);
 }
 
+// ============ 查询计划诊断 ============
+void SqliteHelper::registerDefaultHotQueries() {
+    registerHotQuery("AccountManager::queryAccountRecord",
+                     "SELECT * FROM account_record WHERE user_id = ? AND is_deleted = ? "
+                     "AND create_time BETWEEN ? AND ? ORDER BY create_time DESC");
+    registerHotQuery("AccountManager::queryAccountRecordPage",
+                     "SELECT * FROM account_record WHERE user_id = ? AND is_deleted = ? "
+                     "AND create_time >= ? AND create_time <= ? AND (create_time, id) < (?, ?) "
+                     "ORDER BY create_time DESC, id DESC LIMIT ?");
+    registerHotQuery("AccountManager::getRecordCount",
+                     "SELECT COUNT(*) FROM account_record WHERE user_id = ? AND is_deleted = ?");
+    registerHotQuery("AccountManager::getPeriodSummary",
+                     "SELECT SUM(sum_cents) FROM daily_rollup WHERE user_id = ? AND day >= ? AND day <= ?");
+    registerHotQuery("bill_handler::handleAddRecord",
+                     "SELECT id FROM account_record WHERE user_id = ? AND bill_date = ? AND amount = ? "
+                     "AND category = ? LIMIT 1");
+    registerHotQuery("bill_handler::stageBillRow",
+                     "SELECT id FROM bill WHERE user_id = ? AND local_id = ?");
+    registerHotQuery("bill_handler::queryCategoryId",
+                     "SELECT id FROM bill_category WHERE user_id = ? AND name = ? AND is_deleted = 0 LIMIT 1");
+    registerHotQuery("bill_handler::handleQueryBills",
+                     "SELECT id, amount, bill_date FROM bill WHERE user_id = ? AND is_deleted = ? "
+                     "AND bill_date >= ? AND bill_date <= ? ORDER BY bill_date DESC");
+}
+
+void SqliteHelper::registerHotQuery(const QString& name, const QString& sql) {
+    QMutexLocker locker(&m_poolMutex);
+    m_hotQueries.append(qMakePair(name, sql));
+}
+
+void SqliteHelper::setQueryPlanDiagnostics(bool enabled) {
+    m_planDiagnostics = enabled;
+}
+
+QStringList SqliteHelper::explainHotQueries() {
+    QList<QPair<QString, QString>> hotQueries;
+    {
+        QMutexLocker locker(&m_poolMutex);
+        hotQueries = m_hotQueries;
+    }
+
+    QStringList issues;
+    QSqlQuery query(connection());
+    for (const auto& hot : hotQueries) {
+        // 未绑定的参数按 NULL 处理，不影响执行计划的选择
+        if (!query.exec("EXPLAIN QUERY PLAN " + hot.second)) {
+            issues << hot.first + "：无法分析 " + query.lastError().text();
+            continue;
+        }
+        QStringList plan;
+        while (query.next()) {
+            QString detail = query.value(3).toString();
+            plan << detail;
+            // "SCAN 表名" 且没有 USING 子句即全表扫描（虚拟表由模块自行检索，不算）；临时 B 树说明排序没有用上索引
+            if ((detail.startsWith("SCAN") && !detail.contains("USING") && !detail.contains("VIRTUAL TABLE"))
+                || detail.contains("USE TEMP B-TREE")) {
+                issues << hot.first + "：" + detail;
+            }
+        }
+        qDebug() << "【查询计划】" << hot.first << plan.join(" | ");
+    }
+
+    for (const QString& issue : issues) {
+        qWarning() << "【查询计划告警】" << issue;
+    }
+    return issues;
+}
+
+// ============ 全文检索 ============
+bool SqliteHelper::hasFullTextIndex() const {
+    return m_fullTextIndex.loadAcquire() != 0;
+}
+
+// ============ 每日汇总 ============
+QStringList SqliteHelper::dailyRollupSchema() {
+    // 汇总键：日期取 create_time 的前 10 位，收支按金额正负区分；金额逐条四舍五入到分，
+    // 增减使用同一表达式，合计始终是整数，与全表扫描逐位一致
+    const QString key = "user_id = old.user_id AND day = substr(old.create_time, 1, 10) "
+                        "AND category = COALESCE(old.category, '') AND type = (old.amount >= 0)";
+    const QString addNew = R"(
+            INSERT INTO daily_rollup(user_id, day, category, type, sum_cents, count)
+            SELECT new.user_id, substr(new.create_time, 1, 10), COALESCE(new.category, ''), new.amount >= 0,
+                   CAST(round(new.amount * 100) AS INTEGER), 1
+            WHERE new.is_deleted = 0
+            ON CONFLICT(user_id, day, category, type)
+            DO UPDATE SET sum_cents = sum_cents + excluded.sum_cents, count = count + 1;
+    )";
+    const QString removeOld = QString(R"(
+            UPDATE daily_rollup SET sum_cents = sum_cents - CAST(round(old.amount * 100) AS INTEGER), count = count - 1
+            WHERE old.is_deleted = 0 AND %1;
+            DELETE FROM daily_rollup WHERE count <= 0 AND %1;
+    )").arg(key);
+
+    return {
+        R"(
+        CREATE TABLE IF NOT EXISTS daily_rollup (
+            user_id INTEGER NOT NULL,
+            day TEXT NOT NULL,             -- 日期 (yyyy-MM-dd)
+            category TEXT NOT NULL,        -- 分类名称（记录无分类时为空串）
+            type INTEGER NOT NULL,         -- 0=支出 1=收入（按金额正负）
+            sum_cents INTEGER NOT NULL,    -- 金额合计（分，支出为负数）
+            count INTEGER NOT NULL,        -- 记录条数
+            PRIMARY KEY (user_id, day, category, type)
+        ) WITHOUT ROWID
+        )",
+        "CREATE TRIGGER IF NOT EXISTS trg_account_record_rollup_insert AFTER INSERT ON account_record "
+        "WHEN new.is_deleted = 0 BEGIN" + addNew + "END",
+        "CREATE TRIGGER IF NOT EXISTS trg_account_record_rollup_delete AFTER DELETE ON account_record "
+        "WHEN old.is_deleted = 0 BEGIN" + removeOld + "END",
+        // 软删除与恢复都是 is_deleted 的更新：先按旧值扣除（旧行未删除时），再按新值加回（新行未删除时）
+        "CREATE TRIGGER IF NOT EXISTS trg_account_record_rollup_update "
+        "AFTER UPDATE OF user_id, amount, category, create_time, is_deleted ON account_record BEGIN"
+        + removeOld + addNew + "END"
+    };
+}
+
+QString SqliteHelper::dailyRollupScanSql(const QString& condition) {
+    QString where = condition.isEmpty() ? QString("is_deleted = 0")
+                                        : QString("is_deleted = 0 AND (%1)").arg(condition);
+    return "SELECT user_id, substr(create_time, 1, 10), COALESCE(category, ''), amount >= 0, "
+           "SUM(CAST(round(amount * 100) AS INTEGER)), COUNT(*) "
+           "FROM account_record WHERE " + where + " GROUP BY 1, 2, 3, 4";
+}
+
+bool SqliteHelper::rebuildDailyRollup() {
+    QElapsedTimer timer;
+    timer.start();
+    if (!beginTransaction()) return false;
+    if (!executeSql("DELETE FROM daily_rollup")
+        || !executeSql("INSERT INTO daily_rollup(user_id, day, category, type, sum_cents, count) " + dailyRollupScanSql())) {
+        QString error = getLastError();
+        rollbackTransaction();
+        setLastError("重建每日汇总失败：" + error);
+        qDebug() << getLastError();
+        return false;
+    }
+    if (!commitTransaction()) return false;
+    qDebug() << "每日汇总重建完成，耗时" << timer.elapsed() << "ms";
+    return true;
+}
+
+QStringList SqliteHelper::checkDailyRollup() {
+    QStringList issues;
+    const QString rollup = "SELECT user_id, day, category, type, sum_cents, count FROM daily_rollup";
+    // 两个方向各做一次差集：汇总表缺少或多出的项都会出现
+    const QList<QPair<QString, QString>> checks = {
+        {"汇总缺失或不符", dailyRollupScanSql() + " EXCEPT " + rollup},
+        {"汇总多余", rollup + " EXCEPT " + dailyRollupScanSql()}
+    };
+    QSqlQuery query(connection());
+    for (const auto& check : checks) {
+        if (!query.exec(check.second)) {
+            issues << "无法检查每日汇总：" + query.lastError().text();
+            return issues;
+        }
+        while (query.next()) {
+            issues << QString("%1：用户 %2，%3，%4，%5，合计 %6 分，%7 条")
+                          .arg(check.first).arg(query.value(0).toInt()).arg(query.value(1).toString())
+                          .arg(query.value(2).toString()).arg(query.value(3).toInt() ? "收入" : "支出")
+                          .arg(query.value(4).toLongLong()).arg(query.value(5).toLongLong());
+        }
+    }
+
+    if (issues.isEmpty()) {
+        qDebug() << "每日汇总与记录一致";
+    }
+    for (const QString& issue : issues) {
+        qWarning() << "【每日汇总不一致】" << issue;
+    }
+    return issues;
+}
+
 // ============ 错误处理 ============
 QString SqliteHelper::getLastError() const {
-    return m_lastError;
+    if (!m_connections.hasLocalData()) return QString();
+    return m_connections.localData()->lastError;
 }
 
 void SqliteHelper::clearError() {
-    m_lastError = "";
+    setLastError("");
 }
 
 // ============ 私有方法 ============
@@ -586,17 +1918,9 @@ bool SqliteHelper::createIndexes() {
         "CREATE INDEX IF NOT EXISTS idx_account_create_time ON account_record(create_time)"
     };
 
-    bool txnStarted = beginTransaction();
+    // 由迁移在事务中调用
     for (const QString& sql : stmts) {
-        if (!executeSql(sql)) {
-            if (txnStarted) {
-                rollbackTransaction();
-            }
-            return false;
-        }
-    }
-    if (txnStarted && !commitTransaction()) {
-        return false;
+        if (!executeSql(sql)) return false;
     }
     return true;
 }
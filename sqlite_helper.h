@@ -4,6 +4,7 @@
 #include <QSqlDatabase>//QSqlDatabase 类代表一个数据库连接，它的主要职责是处理与数据库的连接、配置和事务管理。
 #include <QSqlQuery>//QSqlQuery 类用于在已经建立的 QSqlDatabase 连接上执行 SQL 语句，以及导航和检索查询结果。
 #include <QSqlError>
+#include <QSqlRecord>
 #include <QMutex>//#include <QMutex> 是 C++ 中用于包含 Qt 框架中互斥锁（Mutex）类的头文件指令。
 //在多线程编程中，QMutex 是一个非常重要的类，用于保护共享数据，防止多个线程同时访问造成数据竞争
 #include <QString>
@@ -13,20 +14,110 @@
 #include <QDir>
 #include <QDateTime>
 #include <QStringList>
+#include <QJsonObject>
+#include <QThreadStorage>
+#include <QAtomicInteger>
+#include <QHash>
+#include <QList>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+#include <functional>
+#include <memory>
+#include <unordered_map>
 
 class SqliteHelper {
 public:
+    // ============ 持久化配置档 ============
+    // 一组同时生效的连接级 PRAGMA，按数据库用途选择
+    struct DurabilityProfile {
+        QString name;
+        QString journalMode;        // journal_mode：WAL / DELETE / MEMORY
+        QString synchronous;        // synchronous：OFF / NORMAL / FULL
+        qint64 mmapSize = 0;        // mmap_size（字节，0 表示不使用内存映射）
+        int cacheSize = -2000;      // cache_size（负数表示 KiB）
+        QString tempStore;          // temp_store：DEFAULT / FILE / MEMORY
+        int walAutoCheckpoint = 1000; // wal_autocheckpoint（页，0 表示关闭自动检查点）
+
+        // 客户端：WAL + NORMAL，界面读写不互相阻塞，断电最多丢失最近一次提交
+        static DurabilityProfile interactiveClient();
+        // 服务端：更大的缓存和映射区，检查点间隔拉长以换取吞吐
+        static DurabilityProfile serverThroughput();
+        // 批量导入：关闭同步和自动检查点，导入完成后应切回其他配置档
+        static DurabilityProfile bulkImport();
+        // 按名称查找（"interactive-client" / "server-throughput" / "bulk-import"），未知名称返回客户端配置
+        static DurabilityProfile byName(const QString& name, bool* ok = nullptr);
+    };
+
     // ============ 单例管理 ============
     static SqliteHelper* getInstance();
     ~SqliteHelper();
 
     // ============ 数据库连接 ============
-    // 打开数据库
-    bool openDatabase(const QString& dbPath = "./account_book.db");
+    // 打开数据库（profileName 为持久化配置档名称）。参数为空表示沿用已打开的数据库和配置档，
+    // 首次打开时分别取 ./account_book.db 和 interactive-client。
+    // 已打开其他文件时返回 false；同一文件指定了不同配置档时切换过去
+    bool openDatabase(const QString& dbPath = QString(), const QString& profileName = QString());
     // 关闭数据库
     void closeDatabase();
-    // 获取数据库实例
+    // 当前数据库文件路径（未打开时为空）
+    QString databasePath();
+    // 获取数据库实例（当前线程的专属连接）
     QSqlDatabase getDatabase();
+    // 切换持久化配置档（当前线程立即生效，其他线程在下次访问时生效）
+    bool setDurabilityProfile(const QString& profileName);
+    DurabilityProfile getDurabilityProfile();
+    // 在作用域内切换持久化配置档，离开作用域时切回原配置档（批量导入、恢复备份时使用）。
+    // 配置档是进程级的，期间其他线程的连接也按新配置档运行；profileName 为空或调用方已在事务中时不切换
+    class ScopedDurabilityProfile {
+    public:
+        ScopedDurabilityProfile(SqliteHelper* helper, const QString& profileName);
+        ~ScopedDurabilityProfile();
+        ScopedDurabilityProfile(const ScopedDurabilityProfile&) = delete;
+        ScopedDurabilityProfile& operator=(const ScopedDurabilityProfile&) = delete;
+
+    private:
+        SqliteHelper* m_helper;
+        QString m_previous;   // 切换前的配置档，为空表示没有切换
+    };
+    // 查询当前连接实际生效的 PRAGMA 值
+    QString getEffectiveSettings();
+
+    // ============ 预编译语句句柄 ============
+    // 从当前线程的语句缓存借出的预编译语句：只能移动不能复制，同一条语句同一时刻只有一个持有者。
+    // 析构（或 finish()）时复位语句，析构时归还缓存；借出期间再次请求同一 SQL 会另行编译一条
+    class CachedQuery {
+    public:
+        CachedQuery();
+        CachedQuery(CachedQuery&& other) noexcept;
+        CachedQuery& operator=(CachedQuery&& other) noexcept;
+        CachedQuery(const CachedQuery&) = delete;
+        CachedQuery& operator=(const CachedQuery&) = delete;
+        ~CachedQuery();
+
+        QSqlQuery& query() { return *m_query; }
+        const QSqlQuery& query() const { return *m_query; }
+        operator const QSqlQuery&() const { return *m_query; }
+
+        bool next() { return m_query->next(); }
+        QVariant value(int index) const { return m_query->value(index); }
+        QVariant value(const QString& name) const { return m_query->value(name); }
+        QSqlRecord record() const { return m_query->record(); }
+        bool isActive() const { return m_query->isActive(); }
+        QSqlError lastError() const { return m_query->lastError(); }
+        int numRowsAffected() const { return m_query->numRowsAffected(); }
+        QVariant lastInsertId() const { return m_query->lastInsertId(); }
+        void finish() { m_query->finish(); }
+
+    private:
+        friend class SqliteHelper;
+        void release();
+
+        std::unique_ptr<QSqlQuery> m_query;
+        SqliteHelper* m_owner = nullptr;   // 为空表示不归还缓存（未编译成功或缓存已禁用）
+        QString m_sql;
+        QString m_connectionName;          // 借出时的连接名，连接重建后不再归还
+    };
 
     // ============ SQL执行（支持参数化查询防止SQL注入） ============
     // 执行SQL语句（增删改）
@@ -36,7 +127,59 @@ public:
     // 执行查询SQL
     QSqlQuery executeQuery(const QString& sql);
     // 执行参数化查询（防止SQL注入）
-    QSqlQuery executeQueryWithParams(const QString& sql, const QVariantList& params);
+    // 返回的语句借自预编译缓存，离开作用域时归还；单行查询读取完毕后请调用 finish() 尽早释放读锁
+    CachedQuery executeQueryWithParams(const QString& sql, const QVariantList& params);
+
+    // ============ 预编译语句缓存 ============
+    // 缓存统计（命中/未命中计数为全局累计值，语句数为当前线程连接的缓存大小）
+    struct StatementCacheStats {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 evictions = 0;
+        int cachedStatements = 0;
+        int capacity = 0;
+    };
+    // 设置每个连接最多缓存的语句数（0 表示禁用缓存）
+    void setStatementCacheCapacity(int capacity);
+    StatementCacheStats getStatementCacheStats();
+    // 清空当前线程连接的语句缓存
+    void clearStatementCache();
+    void resetStatementCacheStats();
+
+    // ============ 异步执行 ============
+    // 在数据库线程池中执行任意任务（任务内可直接调用同步接口，使用的是该线程自己的连接）
+    template<typename T>
+    QFuture<T> runAsync(std::function<T()> task) {
+        return QtConcurrent::run(dbThreadPool(), task);
+    }
+    // 数据库专用线程池：线程常驻，保留各自的连接和语句缓存
+    QThreadPool* dbThreadPool();
+
+    // ============ 批量写入 ============
+    // 批量写入结果
+    struct BulkWriteResult {
+        bool success = false;
+        int rowsWritten = 0;     // 已提交的行数（失败时为之前各块已提交的行数）
+        QList<qint64> rowIds;    // 已写入行的行 ID，顺序与输入一致
+    };
+    // 列式批量插入：columnValues[i] 为 columns[i] 列的全部取值，通过 execBatch 绑定，每 chunkSize 行提交一次
+    // 调用方已开启事务时并入该事务，不再分块提交。
+    // 行 ID：显式提供 id 列时取该列；否则在同一事务内核对本块新增行的 rowid 恰为连续区间，核对不通过时整块失败
+    BulkWriteResult bulkInsert(const QString& table, const QStringList& columns,
+                               const QList<QVariantList>& columnValues, int chunkSize = 5000);
+    // 列式批量插入或更新：与 conflictColumns 上的唯一约束冲突时更新其余列，同样通过 execBatch 绑定；
+    // 写入后按冲突列查回行 ID（冲突列不能为 NULL）
+    BulkWriteResult bulkUpsert(const QString& table, const QStringList& columns,
+                               const QList<QVariantList>& columnValues,
+                               const QStringList& conflictColumns, int chunkSize = 5000);
+    // 列式批量插入，逐行执行 INSERT ... RETURNING rowid，行 ID 由数据库直接返回而不是由 lastInsertId 推算
+    // chunkSize <= 0 时整批在一个事务中提交
+    BulkWriteResult bulkInsertReturning(const QString& table, const QStringList& columns,
+                                        const QList<QVariantList>& columnValues, int chunkSize = 5000);
+    // 大批量导入账单：在一个事务内暂停 account_record 的插入触发器（每日汇总、全文索引），
+    // execBatch 写入后按行 ID 区间一次性补齐汇总和索引，再恢复触发器；期间使用 bulk-import 配置档。
+    // 调用方已开启事务时并入该事务
+    BulkWriteResult importAccountRecords(const QStringList& columns, const QList<QVariantList>& columnValues);
 
     // ============ 事务管理 ============
     bool beginTransaction();
@@ -44,9 +187,9 @@ public:
     bool rollbackTransaction();
 
     // ============ 数据库备份与恢复 ============
-    // 创建数据库备份（带时间戳）
+    // 创建数据库备份（带时间戳，在线逐页复制；需要后台执行和进度通知时使用 SqliteBackup）
     bool createBackup(const QString& backupDir = "./backups");
-    // 恢复数据库备份
+    // 恢复数据库备份（逐页写回当前数据库）
     bool restoreBackup(const QString& backupFilePath);
     // 列出所有备份文件
     QStringList listBackups(const QString& backupDir = "./backups");
@@ -54,24 +197,95 @@ public:
     bool deleteBackup(const QString& backupFilePath);
 
     // ============ 数据库维护与优化 ============
-    // 优化数据库（VACUUM + ANALYZE）
+    // 空间指标（判断是否需要维护）
+    struct SpaceMetrics {
+        int pageSize = 0;
+        qint64 pageCount = 0;
+        qint64 freelistCount = 0;    // 空闲页数
+        int autoVacuum = 0;          // 0=NONE 1=FULL 2=INCREMENTAL
+        qint64 walSizeBytes = 0;     // -wal 文件大小
+        double fragmentation = 0;    // 空闲页占总页数的比例
+    };
+    // 优化数据库（回收全部空闲页 + PRAGMA optimize，不再整库 VACUUM）
     bool optimizeDatabase();
+    SpaceMetrics getSpaceMetrics();
+    // 距最近一次业务读写的毫秒数（维护调度据此判断是否空闲）
+    qint64 idleMsecs() const;
+    // 写入计数：每次写入、提交或回滚后递增，数据库统计缓存据此判断是否过期
+    qint64 writeGeneration() const;
+    // 账单写入计数：只在写入 account_record / daily_rollup（含删除用户时的级联删除）以及
+    // 包含这类写入的事务提交或回滚后递增，账单相关的内存缓存据此判断数据是否被其他路径改动
+    qint64 recordGeneration() const;
+    // 整库内容被替换后调用（恢复备份的页复制、逐表复制都不经过写入接口）：同时递增两个写入计数，
+    // 按计数判断过期的缓存（数据库统计、月度缓存、区间合计、预算计数）随之失效
+    void markDataReplaced();
+    // 本线程写入后调用：generationBefore 是写入前读到的账单写入计数，若此后的递增全部来自本线程的写入，
+    // 返回本线程最后一次递增后的计数，写穿透据此把缓存从写入前推进到写入后；
+    // 期间有其他线程写入（或本线程没有写入）时返回 -1，调用方应放弃写穿透
+    qint64 ownRecordGeneration(qint64 generationBefore);
     // 检查数据库完整性
     bool checkIntegrity();
     // 启用外键约束
     bool enableForeignKeys();
     // 修复孤立记录
     bool fixOrphanedRecords();
-    // 获取数据库统计信息
-    QString getDatabaseStatistics();
+    // 数据库统计信息（一次聚合查询得到，写入后失效）
+    struct DatabaseStatistics {
+        qint64 userCount = 0;
+        qint64 liveRecordCount = 0;      // 未删除记录数
+        qint64 deletedRecordCount = 0;   // 已软删除记录数
+        double totalIncome = 0;          // 未删除记录中金额 >= 0 的合计
+        double totalExpense = 0;         // 未删除记录中金额 < 0 的绝对值合计
+        qint64 pageCount = 0;
+        qint64 freelistCount = 0;
+        int pageSize = 0;
+        QDateTime computedAt;
+        QJsonObject toJson() const;
+    };
+    // 获取数据库统计信息（未发生写入时直接返回缓存）
+    DatabaseStatistics getDatabaseStatistics();
+
+    // ============ 全文检索 ============
+    // 账单全文索引 account_record_fts 是否可用（SQLite 未编入 FTS5 时为 false，搜索退回 LIKE）
+    bool hasFullTextIndex() const;
+
+    // ============ 每日汇总 ============
+    // daily_rollup 按 (用户, 日期, 分类, 收支) 保存未删除记录的金额合计（分）与条数，
+    // 由 account_record 上的触发器随增删改与软删除/恢复同步维护，月度、年度合计直接从这里读取
+    // 建表与触发器语句（DbBenchmark 也用它在临时库中建表）
+    static QStringList dailyRollupSchema();
+    // 全表扫描得到的汇总结果，列与 daily_rollup 一致；condition 非空时只汇总满足条件的记录
+    static QString dailyRollupScanSql(const QString& condition = QString());
+    // 清空后按全表扫描重新汇总（一个事务内完成）
+    bool rebuildDailyRollup();
+    // 对比 daily_rollup 与全表扫描的结果，返回不一致的项，为空表示一致
+    QStringList checkDailyRollup();
+
+    // ============ 查询计划诊断 ============
+    // 登记热点查询（SQL 中的参数用 ? 占位即可）
+    void registerHotQuery(const QString& name, const QString& sql);
+    // 开启后 openDatabase 完成时检查全部热点查询（也可设置环境变量 ACCOUNTBOOK_EXPLAIN_QUERIES）
+    void setQueryPlanDiagnostics(bool enabled);
+    // 对全部热点查询执行 EXPLAIN QUERY PLAN，返回发现的问题（全表扫描、临时排序）
+    QStringList explainHotQueries();
 
     // ============ 版本管理 ============
-    // 初始化版本管理
+    // 最近一次 openDatabase 的耗时报告
+    struct OpenReport {
+        bool coldStart = false;   // 是否执行了迁移
+        int fromVersion = 0;
+        int toVersion = 0;
+        qint64 elapsedMs = 0;
+    };
+    // 初始化版本管理（执行所有尚未应用的迁移）
     bool initializeVersion();
     // 获取当前数据库版本
     int getCurrentVersion();
     // 设置数据库版本
     bool setVersion(int version);
+    // 迁移登记表中的最新版本
+    int latestVersion() const;
+    OpenReport getLastOpenReport() const { return m_lastOpenReport; }
 
     // ============ 错误处理 ============
     QString getLastError() const;
@@ -83,12 +297,136 @@ private:
     SqliteHelper(const SqliteHelper&) = delete;
     SqliteHelper& operator=(const SqliteHelper&) = delete;
 
+    // ============ 连接池 ============
+    // Qt 要求 QSqlDatabase 只能在创建它的线程中使用，
+    // 因此每个线程持有一个具名连接，线程退出时由 QThreadStorage 自动关闭并移除
+    struct ThreadConnection {
+        QString name;          // 连接名（进程内唯一）
+        int generation = -1;   // 打开时的连接代数，close/reopen 后其他线程据此重连
+        int profileGeneration = -1;  // 已应用的配置档版本
+        bool inTransaction = false;  // 事务内不能切换 journal_mode / synchronous
+        bool recordWriteInTransaction = false;  // 当前事务内写过账单数据，结束事务时递增账单写入计数
+        qint64 ownRecordFrom = -1;   // 本线程最近一段连续递增的账单写入计数区间 [from, to)，
+        qint64 ownRecordTo = -1;     // 区间内的递增全部来自本线程
+        QString lastError;     // 本线程最近一次错误信息
+        std::unordered_map<QString, std::unique_ptr<QSqlQuery>> statements;  // 空闲的预编译语句（按 SQL 文本）
+        QList<QString> statementLru;           // 最近使用顺序，末尾为最新
+        ~ThreadConnection();
+        void release();        // 关闭并移除本线程连接
+        void clearStatements();
+        void touchStatement(const QString& sql);
+        int trimStatements(int capacity);      // 淘汰超出容量的语句，返回淘汰数
+    };
+
+    // 获取当前线程的上下文（不存在则创建，但不打开连接）
+    ThreadConnection* threadContext();
+    // 获取当前线程的连接（按需打开）
+    QSqlDatabase connection();
+    // 新连接打开后的初始化（连接级 PRAGMA）
+    void configureConnection(QSqlDatabase& db);
+    // 应用持久化配置档
+    void applyDurabilityProfile(QSqlDatabase& db, const DurabilityProfile& profile);
+    // 记录当前线程的错误信息
+    void setLastError(const QString& error);
+    // 从缓存借出可复用的预编译语句，未命中时编译一条新的
+    bool acquireStatement(const QString& sql, CachedQuery& statement);
+    // CachedQuery 析构时调用：复位后放回当前线程的缓存（连接已重建或同一 SQL 已有空闲语句时丢弃）
+    void releaseStatement(CachedQuery& statement);
+    // 批量写入方式：execBatch 插入 / 逐行 RETURNING 插入 / execBatch 插入或更新
+    enum class BulkMode { Insert, InsertReturning, Upsert };
+    // 按块执行批量写入，行 ID 的取得方式由 mode 决定（Upsert 时按 keyColumns 查回）
+    BulkWriteResult bulkWrite(const QString& table, const QString& sql, const QStringList& columns,
+                              const QList<QVariantList>& columnValues, int chunkSize,
+                              BulkMode mode, const QStringList& keyColumns = QStringList());
+    // execBatch 插入后取得本块行 ID：显式 id 列或 maxRowIdBefore 之后的连续 rowid 区间
+    bool collectInsertedIds(const QString& table, const QStringList& columns,
+                            const QList<QVariantList>& columnValues, int offset, int count,
+                            qint64 maxRowIdBefore, QList<qint64>& ids);
+    // 按唯一键逐行查回本块行 ID
+    bool collectKeyIds(const QString& table, const QStringList& columns,
+                       const QList<QVariantList>& columnValues, const QStringList& keyColumns,
+                       int offset, int count, QList<qint64>& ids);
+
     // ============ 私有成员 ============
     static SqliteHelper* m_instance;
     static QMutex m_mutex;
-    QSqlDatabase m_db;
-    QString m_lastError;
+    QMutex m_poolMutex;                          // 保护 m_dbPath / m_initialized / m_profile
+    QMutex m_initMutex;                          // 串行化 openDatabase 的建表流程
+    QThreadStorage<ThreadConnection*> m_connections;
+    QAtomicInteger<int> m_connectionSerial;      // 连接名序号
+    QAtomicInteger<int> m_generation;            // 连接代数
+    QAtomicInteger<int> m_profileGeneration;     // 配置档版本
+    DurabilityProfile m_profile;                 // 受 m_poolMutex 保护
+    QAtomicInteger<int> m_statementCacheCapacity{64};
+    QAtomicInteger<qint64> m_statementHits;
+    QAtomicInteger<qint64> m_statementMisses;
+    QAtomicInteger<qint64> m_statementEvictions;
+    bool m_initialized = false;
     QString m_dbPath;
+    QThreadPool* m_dbPool = nullptr;
+    QAtomicInteger<qint64> m_lastActivityMs;      // 最近一次业务读写时间
+    void markActivity();
+    // 写入计数：每次写入/提交/回滚递增，用于判定缓存是否过期
+    QAtomicInteger<qint64> m_writeGeneration;
+    QAtomicInteger<qint64> m_recordGeneration;
+    // 执行一条语句后调用：只有写语句递增写入计数，涉及账单数据时同时递增账单写入计数
+    void markWrite(const QString& sql);
+    // 提交或回滚后调用
+    void markTransactionEnd();
+    // 递增账单写入计数，并记入本线程的连续递增区间
+    void bumpRecordGeneration(ThreadConnection* ctx);
+    static bool isMutatingStatement(const QString& sql);
+    static bool touchesRecordData(const QString& sql);
+    QMutex m_statsMutex;
+    DatabaseStatistics m_statsCache;
+    qint64 m_statsGeneration = -1;
+    OpenReport m_lastOpenReport;
+    QAtomicInteger<int> m_fullTextIndex;          // 全文索引是否存在，由 ensureFullTextIndex 检测
+
+    // ============ 迁移 ============
+    struct Migration {
+        int version;
+        QString description;
+        bool (SqliteHelper::*apply)();
+        bool transactional = true;   // VACUUM 等语句不能在事务中执行
+    };
+    // 按版本升序登记的迁移
+    QList<Migration> migrations() const;
+    // 依次执行版本号大于 currentVersion 的迁移
+    bool runMigrations(int currentVersion);
+    // 列不存在时补加
+    bool ensureColumn(const QString& table, const QString& column, const QString& definition);
+    // 版本 1：基础表结构
+    bool migrateBaselineSchema();
+    // 版本 2：按热点查询设计的复合/覆盖索引
+    bool migrateCompositeIndexes();
+    // 版本 3：切换为增量自动清理（auto_vacuum = INCREMENTAL）
+    bool migrateIncrementalVacuum();
+    // 版本 4：记录索引带上 id，键集分页按 (create_time, id) 排序时无需额外排序
+    bool migrateKeysetIndex();
+    // 版本 5：把旧数据的分类/备注回填到 category/remark 列
+    bool migrateLegacyRecordColumns();
+    // 版本 6：空操作（全文索引改由 ensureFullTextIndex 维护）
+    bool migrateFullTextIndex();
+    // 分类/备注/描述的 FTS5 全文索引及同步触发器，缺失且 SQLite 支持时补建；每次打开数据库时调用
+    bool ensureFullTextIndex();
+    // 全文索引的建表与同步触发器语句
+    static QStringList fullTextIndexSchema();
+    // 版本 7：create_time 的整数秒列 bill_ts
+    bool migrateBillTimestamp();
+    // 版本 8：记录索引带上 category，按月分类汇总只读索引
+    bool migrateStatisticsIndex();
+    // 版本 9：每日汇总表 daily_rollup 及同步触发器
+    bool migrateDailyRollup();
+    // 版本 10：每个用户的汇总版本号 rollup_revision
+    bool migrateRollupRevision();
+    // 版本 11：多条预算规则 budget_rule，迁入 budget 表中的日、月、年预算
+    bool migrateBudgetRules();
+
+    // ============ 查询计划诊断 ============
+    void registerDefaultHotQueries();
+    QList<QPair<QString, QString>> m_hotQueries;  // (名称, SQL)，受 m_poolMutex 保护
+    bool m_planDiagnostics = false;
 
     // ============ 私有方法 ============
     // 创建数据库索引
@@ -1,4 +1,8 @@
 #include "statistics_manager.h"
+#include "category_registry.h"
+#include "month_cache.h"
+#include "timestamp_parser.h"
+#include <QHash>
 #include <algorithm>
 
 StatisticsManager* StatisticsManager::m_instance = nullptr;
@@ -14,72 +18,79 @@ StatisticsManager::StatisticsManager(QObject *parent) : QObject(parent) {}
 
 MonthlyStat StatisticsManager::getMonthlyStat(int userId, int year, int month) {
     MonthlyStat stat;
-    stat.totalIncome = 0;
-    stat.totalExpense = 0;
-    stat.balance = 0;
-
-    QList<AccountRecord> records = m_accountManager.queryMonthlyRecords(userId, year, month);
-    
-    QMap<QString, double> expenseMap;
-    QMap<QString, double> incomeMap;
-
-    for (const auto& record : records) {
-        double amount = record.getAmount();
-        if (amount < 0) {
-            stat.totalExpense += qAbs(amount);
-            expenseMap[record.getType()] += qAbs(amount);
-        } else {
-            stat.totalIncome += amount;
-            incomeMap[record.getType()] += amount;
-        }
-    }
+    QDate firstDay(year, month, 1);
+    int daysInMonth = firstDay.daysInMonth();
 
-    stat.balance = stat.totalIncome - stat.totalExpense;
-
-    // Process Daily Stats
-    int daysInMonth = QDate(year, month, 1).daysInMonth();
-    QMap<int, DailyStat> dailyMap;
-    for (int i = 1; i <= daysInMonth; ++i) {
-        dailyMap[i] = {i, 0, 0};
-    }
+    // 按天与按分类编号（CategoryRegistry）索引的合计，单位：分
+    QList<qint64> dailyIncome;
+    QList<qint64> dailyExpense;
+    QList<qint64> expenseByCategory;
+    QList<qint64> incomeByCategory;
+    CategoryRegistry* registry = CategoryRegistry::getInstance();
 
-    for (const auto& record : records) {
-        QDateTime dt = QDateTime::fromString(record.getCreateTime(), "yyyy-MM-dd HH:mm:ss");
-        if (!dt.isValid()) {
-            dt = QDateTime::fromString(record.getCreateTime(), "yyyy-MM-dd");
+    RecordColumns columns;
+    if (MonthCache::getInstance()->lookupColumns(userId, year, month, columns)) {
+        // 月份已在缓存中：直接遍历列式快照的整数数组
+        columns.sumByDay(TimestampParser::dayStart(firstDay), daysInMonth, dailyIncome, dailyExpense);
+        expenseByCategory = columns.sumByCategory(true);
+        incomeByCategory = columns.sumByCategory(false);
+    } else {
+        // 未缓存：从每日汇总表取回按日、按分类的合计
+        MonthlyTotals totals;
+        m_accountManager.queryMonthlyTotals(userId, year, month, totals);
+        dailyIncome = QList<qint64>(daysInMonth, 0);
+        dailyExpense = QList<qint64>(daysInMonth, 0);
+        for (const DailyTotal& total : totals.days) {
+            if (total.day < 1 || total.day > daysInMonth) continue;
+            dailyIncome[total.day - 1] = total.incomeCents;
+            dailyExpense[total.day - 1] = total.expenseCents;
         }
-        if (dt.isValid()) {
-            int day = dt.date().day();
-            double amount = record.getAmount();
-            if (amount < 0) {
-                dailyMap[day].expense += qAbs(amount);
-            } else {
-                dailyMap[day].income += amount;
+        for (const CategoryTotal& total : totals.categories) {
+            int id = registry->intern(total.category, total.expenseCents > 0 ? 0 : 1);
+            if (id >= expenseByCategory.size()) {
+                expenseByCategory.resize(id + 1);
+                incomeByCategory.resize(id + 1);
             }
+            expenseByCategory[id] = total.expenseCents;
+            incomeByCategory[id] = total.incomeCents;
         }
     }
-    for (int i = 1; i <= daysInMonth; ++i) {
-        stat.dailyStats.append(dailyMap[i]);
+
+    qint64 incomeCents = 0;
+    qint64 expenseCents = 0;
+    for (int id = 0; id < expenseByCategory.size(); ++id) {
+        incomeCents += incomeByCategory[id];
+        expenseCents += expenseByCategory[id];
     }
+    stat.totalIncome = RecordColumns::toYuan(incomeCents);
+    stat.totalExpense = RecordColumns::toYuan(expenseCents);
+    stat.balance = stat.totalIncome - stat.totalExpense;
 
-    // Process Expense Stats
-    for (auto it = expenseMap.begin(); it != expenseMap.end(); ++it) {
-        CategoryStat cs;
-        cs.category = it.key();
-        cs.amount = it.value();
-        cs.percentage = (stat.totalExpense > 0) ? (cs.amount / stat.totalExpense * 100) : 0;
-        cs.color = getCategoryColor(cs.category);
-        stat.expenseStats.append(cs);
+    // Process Daily Stats
+    for (int i = 0; i < daysInMonth; ++i) {
+        stat.dailyStats.append({i + 1, RecordColumns::toYuan(dailyIncome[i]), RecordColumns::toYuan(dailyExpense[i])});
     }
 
-    // Process Income Stats
-    for (auto it = incomeMap.begin(); it != incomeMap.end(); ++it) {
-        CategoryStat cs;
-        cs.category = it.key();
-        cs.amount = it.value();
-        cs.percentage = (stat.totalIncome > 0) ? (cs.amount / stat.totalIncome * 100) : 0;
-        cs.color = getCategoryColor(cs.category);
-        stat.incomeStats.append(cs);
+    // Process Expense / Income Stats：名称与颜色取自分类注册表
+    for (int id = 0; id < expenseByCategory.size(); ++id) {
+        if (expenseByCategory[id] <= 0 && incomeByCategory[id] <= 0) continue;
+        CategoryInfo info = registry->info(id);
+        if (expenseByCategory[id] > 0) {
+            CategoryStat cs;
+            cs.category = info.name;
+            cs.amount = RecordColumns::toYuan(expenseByCategory[id]);
+            cs.percentage = (stat.totalExpense > 0) ? (cs.amount / stat.totalExpense * 100) : 0;
+            cs.color = info.color;
+            stat.expenseStats.append(cs);
+        }
+        if (incomeByCategory[id] > 0) {
+            CategoryStat cs;
+            cs.category = info.name;
+            cs.amount = RecordColumns::toYuan(incomeByCategory[id]);
+            cs.percentage = (stat.totalIncome > 0) ? (cs.amount / stat.totalIncome * 100) : 0;
+            cs.color = info.color;
+            stat.incomeStats.append(cs);
+        }
     }
 
     // Sort by amount descending
@@ -92,17 +103,107 @@ MonthlyStat StatisticsManager::getMonthlyStat(int userId, int year, int month) {
     return stat;
 }
 
-QString StatisticsManager::getCategoryColor(const QString& category) {
-    static QMap<QString, QString> colors = {
-        {"餐饮", "#FF6B6B"}, {"服饰", "#4ECDC4"}, {"日用", "#45B7D1"},
-        {"数码", "#96CEB4"}, {"美妆", "#FFEEAD"}, {"软件", "#D4A5A5"},
-        {"住房", "#9A8C98"}, {"交通", "#C9ADA7"}, {"娱乐", "#F2CC8F"},
-        {"医疗", "#E07A5F"}, {"通讯", "#3D405B"}, {"汽车", "#81B29A"},
-        {"学习", "#F4F1DE"}, {"办公", "#A8DADC"}, {"运动", "#457B9D"},
-        {"社交", "#1D3557"}, {"宠物", "#E63946"}, {"旅行", "#A2D2FF"},
-        {"育儿", "#BDE0FE"}, {"其他", "#FFAFCC"},
-        {"工资", "#4CAF50"}, {"兼职", "#8BC34A"}, {"投资", "#CDDC39"},
-        {"副业", "#FFEB3B"}, {"红包", "#FFC107"}, {"意外收入", "#FF9800"}
-    };
-    return colors.value(category, "#CCCCCC");
+// ============ 多周期趋势 ============
+TrendSeries StatisticsManager::getTrend(int userId, const QDate& firstDay, const QDate& lastDay,
+                                        PeriodGranularity granularity, int topCount) {
+    TrendSeries series;
+    series.m_granularity = granularity;
+    series.m_firstDay = firstDay;
+    series.m_lastDay = lastDay;
+    if (!firstDay.isValid() || !lastDay.isValid() || firstDay > lastDay) {
+        return series;
+    }
+
+    QList<PeriodCategoryTotal> totals;
+    if (!m_accountManager.queryPeriodTotals(userId, firstDay, lastDay, granularity, totals)) {
+        return series;
+    }
+
+    // 先按范围生成连续的周期，再把分组结果按周期首日放入对应位置
+    QList<TrendPoint> points;
+    QHash<qint64, int> indexByStart;
+    for (QDate start = periodStart(granularity, firstDay); start <= lastDay;
+         start = nextPeriodStart(granularity, start)) {
+        TrendPoint point;
+        point.firstDay = qMax(start, firstDay);
+        point.lastDay = qMin(nextPeriodStart(granularity, start).addDays(-1), lastDay);
+        point.label = periodLabel(granularity, start);
+        indexByStart.insert(start.toJulianDay(), points.size());
+        points.append(point);
+    }
+
+    CategoryRegistry* registry = CategoryRegistry::getInstance();
+    QList<qint64> incomeCents(points.size(), 0);
+    QList<qint64> expenseCents(points.size(), 0);
+    for (const PeriodCategoryTotal& total : totals) {
+        int index = indexByStart.value(total.periodStart.toJulianDay(), -1);
+        if (index < 0) continue;
+        incomeCents[index] += total.incomeCents;
+        expenseCents[index] += total.expenseCents;
+
+        int id = registry->intern(total.category, total.expenseCents > 0 ? 0 : 1);
+        if (total.expenseCents > 0) {
+            points[index].topExpense.append({total.category, RecordColumns::toYuan(total.expenseCents), 0,
+                                             registry->color(id)});
+        }
+        if (total.incomeCents > 0) {
+            points[index].topIncome.append({total.category, RecordColumns::toYuan(total.incomeCents), 0,
+                                            registry->color(id)});
+        }
+    }
+
+    for (int i = 0; i < points.size(); ++i) {
+        TrendPoint& point = points[i];
+        point.income = RecordColumns::toYuan(incomeCents[i]);
+        point.expense = RecordColumns::toYuan(expenseCents[i]);
+        point.balance = RecordColumns::toYuan(incomeCents[i] - expenseCents[i]);
+        rankCategories(point.topExpense, point.expense, topCount);
+        rankCategories(point.topIncome, point.income, topCount);
+        series.m_maxAmount = qMax(series.m_maxAmount, qMax(point.income, point.expense));
+    }
+    series.m_points = points;
+    series.m_valid = true;
+    return series;
+}
+
+QDate StatisticsManager::periodStart(PeriodGranularity granularity, const QDate& date) {
+    switch (granularity) {
+    case PeriodGranularity::Day: return date;
+    case PeriodGranularity::Week: return date.addDays(1 - date.dayOfWeek());
+    case PeriodGranularity::Month: return QDate(date.year(), date.month(), 1);
+    case PeriodGranularity::Year: return QDate(date.year(), 1, 1);
+    }
+    return date;
+}
+
+QDate StatisticsManager::nextPeriodStart(PeriodGranularity granularity, const QDate& start) {
+    switch (granularity) {
+    case PeriodGranularity::Day: return start.addDays(1);
+    case PeriodGranularity::Week: return start.addDays(7);
+    case PeriodGranularity::Month: return start.addMonths(1);
+    case PeriodGranularity::Year: return start.addYears(1);
+    }
+    return start.addDays(1);
+}
+
+QString StatisticsManager::periodLabel(PeriodGranularity granularity, const QDate& start) {
+    switch (granularity) {
+    case PeriodGranularity::Day:
+    case PeriodGranularity::Week: return start.toString("MM-dd");
+    case PeriodGranularity::Month: return start.toString("yyyy-MM");
+    case PeriodGranularity::Year: return start.toString("yyyy");
+    }
+    return start.toString("yyyy-MM-dd");
+}
+
+void StatisticsManager::rankCategories(QList<CategoryStat>& stats, double total, int topCount) {
+    for (CategoryStat& stat : stats) {
+        stat.percentage = (total > 0) ? (stat.amount / total * 100) : 0;
+    }
+    std::sort(stats.begin(), stats.end(), [](const CategoryStat& a, const CategoryStat& b) {
+        return a.amount > b.amount;
+    });
+    if (topCount > 0 && stats.size() > topCount) {
+        stats.resize(topCount);
+    }
 }
@@ -30,6 +30,49 @@ struct MonthlyStat {
     QList<DailyStat> dailyStats;
 };
 
+// 趋势中的一个周期
+struct TrendPoint {
+    QDate firstDay;             // 周期首日（已截到查询范围内）
+    QDate lastDay;              // 周期末日（已截到查询范围内）
+    QString label;              // 横轴标签
+    double income = 0;
+    double expense = 0;         // 支出合计（正数）
+    double balance = 0;
+    QList<CategoryStat> topExpense;     // 支出最多的分类，按金额降序，百分比相对本周期
+    QList<CategoryStat> topIncome;
+};
+
+/**
+ * @brief 多周期收支趋势 - 由 StatisticsManager::getTrend 生成后只读。
+ *        周期连续，没有记录的周期合计为 0，图表可以直接按下标绘制；复制时共享底层数据。
+ */
+class TrendSeries
+{
+public:
+    // 查询是否成功（范围无效或读取失败时为 false，且没有周期）
+    bool isValid() const { return m_valid; }
+    PeriodGranularity granularity() const { return m_granularity; }
+    QDate firstDay() const { return m_firstDay; }
+    QDate lastDay() const { return m_lastDay; }
+
+    int size() const { return m_points.size(); }
+    bool isEmpty() const { return m_points.isEmpty(); }
+    const TrendPoint& at(int index) const { return m_points.at(index); }
+    const QList<TrendPoint>& points() const { return m_points; }
+    // 各周期收入、支出中的最大值，图表纵轴范围
+    double maxAmount() const { return m_maxAmount; }
+
+private:
+    friend class StatisticsManager;
+
+    bool m_valid = false;
+    PeriodGranularity m_granularity = PeriodGranularity::Month;
+    QDate m_firstDay;
+    QDate m_lastDay;
+    QList<TrendPoint> m_points;
+    double m_maxAmount = 0;
+};
+
 class StatisticsManager : public QObject
 {
     Q_OBJECT
@@ -38,12 +81,24 @@ public:
     
     MonthlyStat getMonthlyStat(int userId, int year, int month);
 
+    // ============ 多周期趋势 ============
+    // [firstDay, lastDay] 内每个周期的收支与前 topCount 个分类；
+    // 全部周期由 daily_rollup 上的一次分组查询得到，不逐月查询
+    TrendSeries getTrend(int userId, const QDate& firstDay, const QDate& lastDay,
+                         PeriodGranularity granularity = PeriodGranularity::Month, int topCount = 3);
+
+    // 包含 date 的周期的首日，以及下一个周期的首日
+    static QDate periodStart(PeriodGranularity granularity, const QDate& date);
+    static QDate nextPeriodStart(PeriodGranularity granularity, const QDate& start);
+
 private:
     explicit StatisticsManager(QObject *parent = nullptr);
     static StatisticsManager* m_instance;
     AccountManager m_accountManager;
-    
-    QString getCategoryColor(const QString& category);
+
+    static QString periodLabel(PeriodGranularity granularity, const QDate& start);
+    // 计算占比，按金额降序排列后保留前 topCount 个（topCount <= 0 时全部保留）
+    static void rankCategories(QList<CategoryStat>& stats, double total, int topCount);
 };
 
 #endif // STATISTICS_MANAGER_H
@@ -1,6 +1,8 @@
 #include "statistics_widget.h"
 #include <QPainter>
 #include <QGraphicsDropShadowEffect>
+#include <QFutureWatcher>
+#include "sqlite_helper.h"
 
 StatisticsWidget::StatisticsWidget(QWidget *parent) : QWidget(parent)
 {
@@ -141,14 +143,29 @@ void StatisticsWidget::updateData(int userId, int year, int month)
     m_currentMonth = month;
     m_monthLabel->setText(QString("%1-%2").arg(year).arg(month, 2, 10, QChar('0')));
 
-    MonthlyStat stat = StatisticsManager::getInstance()->getMonthlyStat(userId, year, month);
-    
-    m_totalExpenseLabel->setText(QString("总支出 ¥%1").arg(QString::number(stat.totalExpense, 'f', 2)));
-    m_totalIncomeLabel->setText(QString("总收入 ¥%1").arg(QString::number(stat.totalIncome, 'f', 2)));
-    m_balanceLabel->setText(QString("月结余 ¥%1").arg(QString::number(stat.balance, 'f', 2)));
-
-    updateChart(stat.dailyStats);
-    refreshList(stat);
+    // 在数据库线程池中统计，避免大月份卡住界面
+    int requestId = ++m_statLoadSeq;
+    m_statLoadFuture.cancel();  // 尚未开始的旧请求直接取消
+    StatisticsManager *manager = StatisticsManager::getInstance();  // 单例在界面线程创建
+    m_statLoadFuture = SqliteHelper::getInstance()->runAsync<MonthlyStat>([manager, userId, year, month]() {
+        return manager->getMonthlyStat(userId, year, month);
+    });
+
+    auto *watcher = new QFutureWatcher<MonthlyStat>(this);
+    connect(watcher, &QFutureWatcher<MonthlyStat>::finished, this, [this, watcher, requestId]() {
+        watcher->deleteLater();
+        // 期间已切换月份，丢弃过期结果
+        if (requestId != m_statLoadSeq || watcher->isCanceled()) return;
+
+        MonthlyStat stat = watcher->result();
+        m_totalExpenseLabel->setText(QString("总支出 ¥%1").arg(QString::number(stat.totalExpense, 'f', 2)));
+        m_totalIncomeLabel->setText(QString("总收入 ¥%1").arg(QString::number(stat.totalIncome, 'f', 2)));
+        m_balanceLabel->setText(QString("月结余 ¥%1").arg(QString::number(stat.balance, 'f', 2)));
+
+        updateChart(stat.dailyStats);
+        refreshList(stat);
+    });
+    watcher->setFuture(m_statLoadFuture);
 }
 
 void StatisticsWidget::updateChart(const QList<DailyStat>& dailyStats)
@@ -9,6 +9,7 @@
 #include <QScrollArea>
 #include <QFrame>
 #include <QProgressBar>
+#include <QFuture>
 #include "statistics_manager.h"
 
 class ChartWidget : public QWidget {
@@ -68,6 +69,10 @@ private:
     int m_currentMonth;
     bool m_isShowingExpense = true;
 
+    // 后台统计：序号用于丢弃过期结果
+    int m_statLoadSeq = 0;
+    QFuture<MonthlyStat> m_statLoadFuture;
+
     void refreshList(const MonthlyStat& stat);
     void updateChart(const QList<DailyStat>& dailyStats);
 
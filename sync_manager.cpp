@@ -53,15 +53,21 @@ void SyncManager::performSyncTask() {
     m_isSyncing = true;
     emit syncStarted();
 
-    // 使用 ThreadManager 在后台线程获取待同步数据
+    // 使用 ThreadManager 在后台线程获取待同步数据（SqliteHelper 会为该线程分配独立连接）
     ThreadManager::getInstance()->runAsync([user]() {
         AccountManager am;
         // 获取所有本地未同步或需要更新的数据（此处简化为获取该用户所有记录）
-        QList<AccountRecord> records = am.queryAccountRecord(user.getId());
+        // 逐行直接转换为 JSON，不再先复制出完整的记录列表
+        QJsonArray bills;
+        am.forEachRecord(user.getId(), RecordFilter(), [&bills](const RecordRow& row) {
+            bills.append(TcpClient::billToJson(row.toRecord()));
+            return true;
+        });
         
         // 切回主线程（或直接通过单例 TcpClient 发送，TcpClient 内部处理异步网络）
-        QMetaObject::invokeMethod(TcpClient::getInstance(), [records]() {
-            TcpClient::getInstance()->syncBills(records);
+        int userId = user.getId();
+        QMetaObject::invokeMethod(TcpClient::getInstance(), [userId, bills]() {
+            TcpClient::getInstance()->syncBills(userId, bills);
         });
     });
 }
@@ -71,6 +71,22 @@ bool TcpClient::isConnected() const
 }
 
 bool TcpClient::syncBills(const QList<AccountRecord>& bills)
+{
+    if (bills.isEmpty()) {
+        qDebug() << "账单列表为空，无法同步";
+        return false;
+    }
+    
+    // 将账单列表转换为JSON数组
+    QJsonArray billsArray;
+    for (const AccountRecord& bill : bills) {
+        billsArray.append(billToJson(bill));
+    }
+    // 获取用户ID（从第一条记录中获取）
+    return syncBills(bills.first().getUserId(), billsArray);
+}
+
+bool TcpClient::syncBills(int userId, const QJsonArray& bills)
 {
     if (!isConnected()) {
         qDebug() << "未连接到服务端，无法同步账单";
@@ -83,8 +99,6 @@ bool TcpClient::syncBills(const QList<AccountRecord>& bills)
         return false;
     }
     
-    // 获取用户ID（从第一条记录中获取）
-    int userId = bills.first().getUserId();
     if (userId <= 0) {
         qDebug() << "用户ID无效，无法同步";
         emit errorOccurred("用户ID无效");
@@ -95,49 +109,47 @@ bool TcpClient::syncBills(const QList<AccountRecord>& bills)
     message["type"] = "sync_bills";
     message["action"] = "upload";
     message["userId"] = userId;
-    
-    // 将账单列表转换为JSON数组
-    QJsonArray billsArray;
-    for (const AccountRecord& bill : bills) {
-        QJsonObject billObj;
-        // 新增为0，更新时传实际ID
-        billObj["id"] = bill.getId();
-        billObj["userId"] = bill.getUserId();
-        // 支出为负，收入为正
-        billObj["amount"] = bill.getAmount();
-        billObj["type"] = bill.getType();
-        billObj["remark"] = bill.getRemark();
-        billObj["voucherPath"] = bill.getVoucherPath();
-        billObj["isDeleted"] = bill.getIsDeleted();
-        billObj["deleteTime"] = bill.getDeleteTime();
-        
-        // 确保时间格式统一为 yyyy-MM-dd HH:mm:ss
-        QString createTime = bill.getCreateTime();
-        QString modifyTime = bill.getModifyTime();
-        
-        // 如果时间格式不正确，尝试转换
-        if (!createTime.isEmpty() && !createTime.contains(" ")) {
-            // 如果只有日期，添加时间部分
-            createTime = createTime + " 00:00:00";
-        }
-        if (!modifyTime.isEmpty() && !modifyTime.contains(" ")) {
-            modifyTime = modifyTime + " 00:00:00";
-        }
-        
-        billObj["createTime"] = createTime.isEmpty() ? 
-            QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") : createTime;
-        billObj["modifyTime"] = modifyTime.isEmpty() ? 
-            QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") : modifyTime;
-        billsArray.append(billObj);
-    }
-    
-    message["bills"] = billsArray;
+    message["bills"] = bills;
     message["count"] = bills.size();
     
     qDebug() << "发送同步账单请求，用户ID:" << userId << "账单数量:" << bills.size();
     return sendJsonMessage(message);
 }
 
+QJsonObject TcpClient::billToJson(const AccountRecord& bill)
+{
+    QJsonObject billObj;
+    // 新增为0，更新时传实际ID
+    billObj["id"] = bill.getId();
+    billObj["userId"] = bill.getUserId();
+    // 支出为负，收入为正
+    billObj["amount"] = bill.getAmount();
+    billObj["type"] = bill.getType();
+    billObj["remark"] = bill.getRemark();
+    billObj["voucherPath"] = bill.getVoucherPath();
+    billObj["isDeleted"] = bill.getIsDeleted();
+    billObj["deleteTime"] = bill.getDeleteTime();
+    
+    // 确保时间格式统一为 yyyy-MM-dd HH:mm:ss
+    QString createTime = bill.getCreateTime();
+    QString modifyTime = bill.getModifyTime();
+    
+    // 如果时间格式不正确，尝试转换
+    if (!createTime.isEmpty() && !createTime.contains(" ")) {
+        // 如果只有日期，添加时间部分
+        createTime = createTime + " 00:00:00";
+    }
+    if (!modifyTime.isEmpty() && !modifyTime.contains(" ")) {
+        modifyTime = modifyTime + " 00:00:00";
+    }
+    
+    billObj["createTime"] = createTime.isEmpty() ? 
+        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") : createTime;
+    billObj["modifyTime"] = modifyTime.isEmpty() ? 
+        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") : modifyTime;
+    return billObj;
+}
+
 bool TcpClient::addRecord(int userId, const AccountRecord& record)
 {
     if (!isConnected()) {
@@ -175,18 +187,52 @@ bool TcpClient::editRecord(int userId, const AccountRecord& record)
     message["type"] = "edit_record";
     message["userId"] = userId;
     message["recordId"] = record.getId();
+    message["record"] = editedRecordToJson(record);
+
+    qDebug() << "发送编辑记录请求，用户ID:" << userId << "记录ID:" << record.getId();
+    return sendJsonMessage(message);
+}
+
+bool TcpClient::batchEditRecords(int userId, const QList<AccountRecord>& records)
+{
+    if (!isConnected()) {
+        qDebug() << "未连接到服务端，无法批量编辑记录";
+        emit errorOccurred("未连接到服务端");
+        return false;
+    }
+
+    if (records.isEmpty()) {
+        qDebug() << "记录列表为空，无需同步";
+        return false;
+    }
+
+    QJsonArray recordsArray;
+    for (const AccountRecord& record : records) {
+        QJsonObject item;
+        item["recordId"] = record.getId();
+        item["record"] = editedRecordToJson(record);
+        recordsArray.append(item);
+    }
+
+    QJsonObject message;
+    message["type"] = "batch_edit_records";
+    message["userId"] = userId;
+    message["records"] = recordsArray;
+    message["count"] = records.size();
 
+    qDebug() << "发送批量编辑记录请求，用户ID:" << userId << "记录数量:" << records.size();
+    return sendJsonMessage(message);
+}
+
+QJsonObject TcpClient::editedRecordToJson(const AccountRecord& record)
+{
     QJsonObject recordObj;
     recordObj["amount"] = record.getAmount();
     recordObj["type"] = (record.getAmount() >= 0 ? 1 : 0);
     recordObj["billDate"] = record.getCreateTime();
     recordObj["category"] = record.getType();
     recordObj["description"] = record.getRemark();
-
-    message["record"] = recordObj;
-
-    qDebug() << "发送编辑记录请求，用户ID:" << userId << "记录ID:" << record.getId();
-    return sendJsonMessage(message);
+    return recordObj;
 }
 
 bool TcpClient::deleteRecord(int userId, int recordId)
@@ -383,6 +429,7 @@ void TcpClient::parseMessage(const QByteArray& data)
         emit syncBillsResponse(success, msg);
     }
     else if (type == "add_record_response" || type == "edit_record_response" || 
+             type == "batch_edit_records_response" ||
              type == "delete_record_response" || type == "restore_record_response" ||
              type == "permanent_delete_record_response") {
         // 处理记录操作响应
@@ -27,10 +27,18 @@ public:
 
     // 同步账单到服务端
     bool syncBills(const QList<AccountRecord>& bills);
+    // 同步已转换好的账单 JSON 数组（调用方可逐行生成，无需先构造记录列表）
+    bool syncBills(int userId, const QJsonArray& bills);
+    // 将单条账单转换为同步消息中的 JSON 对象
+    static QJsonObject billToJson(const AccountRecord& bill);
+    // 将编辑后的记录转换为 edit_record 消息中的 record 对象
+    static QJsonObject editedRecordToJson(const AccountRecord& record);
     // 添加单条记录到服务端
     bool addRecord(int userId, const AccountRecord& record);
     // 编辑记录同步到服务端
     bool editRecord(int userId, const AccountRecord& record);
+    // 批量编辑记录同步到服务端（一条消息，服务端在一个事务中应用）
+    bool batchEditRecords(int userId, const QList<AccountRecord>& records);
     // 删除记录同步到服务端（软删除）
     bool deleteRecord(int userId, int recordId);
     // 恢复记录同步到服务端
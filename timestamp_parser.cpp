@@ -0,0 +1,91 @@
+#include "timestamp_parser.h"
+#include <QTime>
+
+namespace {
+// 1970-01-01 的儒略日
+const qint64 kEpochJulianDay = 2440588;
+
+// 读取 count 位十进制数字，遇到非数字返回 -1
+inline int readDigits(const QChar* p, int count)
+{
+    int value = 0;
+    for (int i = 0; i < count; ++i) {
+        ushort c = p[i].unicode();
+        if (c < '0' || c > '9') return -1;
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+inline bool isLeapYear(int year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+inline int daysInMonth(int year, int month)
+{
+    static const int days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (month == 2 && isLeapYear(year)) ? 29 : days[month - 1];
+}
+
+// 公历日期到 1970-01-01 的天数（年份为正，无需处理公元前）
+inline qint64 daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    const qint64 era = year / 400;
+    const qint64 yearOfEra = year - era * 400;
+    const qint64 dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const qint64 dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+}
+
+qint64 TimestampParser::parse(QStringView text, bool* ok)
+{
+    *ok = false;
+    const int size = int(text.size());
+    // 只接受三种长度：日期、日期+时分、日期+时分秒
+    if (size != 10 && size != 16 && size != 19) return 0;
+
+    const QChar* p = text.data();
+    if (p[4] != QLatin1Char('-') || p[7] != QLatin1Char('-')) return 0;
+    int year = readDigits(p, 4);
+    int month = readDigits(p + 5, 2);
+    int day = readDigits(p + 8, 2);
+    if (year <= 0 || month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) return 0;
+
+    int hour = 0, minute = 0, second = 0;
+    if (size >= 16) {
+        if ((p[10] != QLatin1Char(' ') && p[10] != QLatin1Char('T')) || p[13] != QLatin1Char(':')) return 0;
+        hour = readDigits(p + 11, 2);
+        minute = readDigits(p + 14, 2);
+        if (hour < 0 || hour > 23 || minute < 0 || minute > 59) return 0;
+        if (size == 19) {
+            if (p[16] != QLatin1Char(':')) return 0;
+            second = readDigits(p + 17, 2);
+            if (second < 0 || second > 59) return 0;
+        }
+    }
+
+    *ok = true;
+    return daysFromCivil(year, month, day) * SecsPerDay + hour * 3600 + minute * 60 + second;
+}
+
+qint64 TimestampParser::dayStart(const QDate& date)
+{
+    return (date.toJulianDay() - kEpochJulianDay) * SecsPerDay;
+}
+
+QDate TimestampParser::toDate(qint64 secs)
+{
+    qint64 days = secs / SecsPerDay;
+    if (secs % SecsPerDay < 0) --days;
+    return QDate::fromJulianDay(days + kEpochJulianDay);
+}
+
+QDateTime TimestampParser::toDateTime(qint64 secs)
+{
+    qint64 secsOfDay = secs % SecsPerDay;
+    if (secsOfDay < 0) secsOfDay += SecsPerDay;
+    return QDateTime(toDate(secs), QTime::fromMSecsSinceStartOfDay(int(secsOfDay * 1000)));
+}
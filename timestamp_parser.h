@@ -0,0 +1,32 @@
+#ifndef TIMESTAMP_PARSER_H
+#define TIMESTAMP_PARSER_H
+
+#include <QString>
+#include <QStringView>
+#include <QDate>
+#include <QDateTime>
+
+/**
+ * @brief 固定格式时间解析 - 代替热点路径上的 QDateTime::fromString。
+ *        支持 yyyy-MM-dd、yyyy-MM-dd HH:mm、yyyy-MM-dd HH:mm:ss（日期与时间之间也可以是 T），
+ *        逐字符校验后直接换算，不分配内存。
+ *        结果为把钟点按 UTC 解释得到的秒数（与 SQLite strftime('%s', create_time) 一致），
+ *        不做时区换算，天数可以直接用整除得到，不受夏令时影响。
+ */
+class TimestampParser
+{
+public:
+    // 是否解析成功只看 ok：任何 qint64 都是合法的秒数（-1 即 1969-12-31 23:59:59），
+    // 格式或取值（月份、当月天数、时分秒范围）不合法时 ok 置为 false，返回值无意义（为 0）
+    static qint64 parse(QStringView text, bool* ok);
+
+    // 某天零点对应的秒数
+    static qint64 dayStart(const QDate& date);
+    // 秒数换回日期 / 本地钟点时间（只用于展示）
+    static QDate toDate(qint64 secs);
+    static QDateTime toDateTime(qint64 secs);
+
+    static const qint64 SecsPerDay = 86400;
+};
+
+#endif // TIMESTAMP_PARSER_H
@@ -125,34 +125,20 @@ QList<AccountRecord> UIHandler::getRecordsByCategory(int userId, const QString&
     return m_accountManager->queryRecordsByType(userId, category);
 }
 
-QList<AccountRecord> UIHandler::searchRecords(int userId, const QString& keyword)
+SearchPage UIHandler::searchRecords(int userId, const QString& keyword, int offset, int pageSize)
 {
-    // 这里简化实现，实际应实现更复杂的搜索逻辑
-    QList<AccountRecord> allRecords = m_accountManager->queryAccountRecord(userId);
-    QList<AccountRecord> results;
-
-    for(const auto& record : allRecords)
-    {
-        if(record.getRemark().contains(keyword, Qt::CaseInsensitive) ||
-            record.getType().contains(keyword, Qt::CaseInsensitive))
-        {
-            results.append(record);
-        }
-    }
-
-    return results;
+    // 关键字匹配交给全文索引完成，每次只取一页
+    return m_accountManager->searchAccountRecords(userId, keyword, offset, pageSize);
 }
 
 double UIHandler::getMonthlyBalance(int userId, int year, int month)
 {
-    QList<AccountRecord> records = getMonthlyRecords(userId, year, month);
-    return m_businessLogic->calculateMonthlyBalance(year, month, records);
+    return m_businessLogic->calculateMonthlyBalance(*m_accountManager, userId, year, month);
 }
 
 QMap<QString, double> UIHandler::getMonthlyCategorySummary(int userId, int year, int month)
 {
-    QList<AccountRecord> records = getMonthlyRecords(userId, year, month);
-    return m_businessLogic->calculateMonthlyCategorySummary(year, month, records);
+    return m_businessLogic->calculateMonthlyCategorySummary(*m_accountManager, userId, year, month);
 }
 
 QStringList UIHandler::getExpenseCategories()
@@ -34,7 +34,8 @@ public:
     QList<AccountRecord> getRecordsByDateRange(int userId, const QDate& start, const QDate& end);
     QList<AccountRecord> getMonthlyRecords(int userId, int year, int month);
     QList<AccountRecord> getRecordsByCategory(int userId, const QString& category);
-    QList<AccountRecord> searchRecords(int userId, const QString& keyword);
+    // 按分类/备注关键字分页搜索（按相关度排序），offset 传上一页返回的 nextOffset
+    SearchPage searchRecords(int userId, const QString& keyword, int offset = 0, int pageSize = 50);
 
     // 统计相关操作
     double getMonthlyBalance(int userId, int year, int month);